@@ -0,0 +1,149 @@
+#include "arena.h"
+
+/* Union of the types with the strictest alignment, used to align every allocation */
+typedef union {
+    long l;
+    double d;
+    void *p;
+} ArenaAlign;
+
+#define ARENA_ALIGN(size) (((size) + sizeof(ArenaAlign) - 1) / sizeof(ArenaAlign) * sizeof(ArenaAlign))
+#define ARENA_HEADER_SIZE ARENA_ALIGN(sizeof(ArenaBlock))
+
+/* Returns a pointer to the first byte of memory of a block */
+static char *block_data(ArenaBlock *block)
+{
+    return (char *)block + ARENA_HEADER_SIZE;
+}
+
+/* 
+ * Initializes an empty arena. No memory is allocated until the first allocation.
+ */
+void arena_init(Arena *arena)
+{
+    arena->blocks = NULL;
+    arena->last = NULL;
+    arena->bytes = 0;
+    arena->on_failure = NULL;
+}
+
+/* 
+ * Allocates memory from the current block, or from a new block when the current one is full.
+ * Requests larger than a block get a block of their own.
+ */
+void *arena_alloc(Arena *arena, size_t size)
+{
+    ArenaBlock *block = arena->blocks;
+    size_t block_size;
+    void *memory;
+
+    size = ARENA_ALIGN(size == 0 ? 1 : size);
+
+    if (block == NULL || block->size - block->used < size)
+    {
+        block_size = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        block = (ArenaBlock *)malloc(ARENA_HEADER_SIZE + block_size);
+        if (block == NULL)
+        {
+            if (arena->on_failure != NULL)
+            {
+                longjmp(*arena->on_failure, 1);
+            }
+            fprintf(stderr, "Unable to allocate memory for arena\n");
+            exit(EXIT_FAILURE);
+        }
+        block->size = block_size;
+        block->used = 0;
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+
+    memory = block_data(block) + block->used;
+    block->used += size;
+    arena->bytes += size;
+    arena->last = memory;
+    return memory;
+}
+
+/* 
+ * Grows an allocation. Growing the most recent allocation only moves the end of the block.
+ */
+void *arena_grow(Arena *arena, void *old, size_t old_size, size_t new_size)
+{
+    ArenaBlock *block = arena->blocks;
+    void *memory;
+
+    if (old != NULL && old == arena->last)
+    {
+        old_size = ARENA_ALIGN(old_size);
+        new_size = ARENA_ALIGN(new_size);
+        if (new_size <= old_size || block->size - block->used >= new_size - old_size)
+        {
+            if (new_size > old_size)
+            {
+                block->used += new_size - old_size;
+                arena->bytes += new_size - old_size;
+            }
+            return old;
+        }
+    }
+
+    memory = arena_alloc(arena, new_size);
+    if (old != NULL)
+    {
+        memcpy(memory, old, old_size < new_size ? old_size : new_size);
+    }
+    return memory;
+}
+
+/* 
+ * Duplicates a string into the arena.
+ */
+char *arena_strdup(Arena *arena, const char *str)
+{
+    size_t length = strlen(str) + 1;
+    char *copy = (char *)arena_alloc(arena, length);
+    memcpy(copy, str, length);
+    return copy;
+}
+
+/* 
+ * Frees every block of the arena but the first one, which is emptied.
+ */
+void arena_reset(Arena *arena)
+{
+    ArenaBlock *block = arena->blocks;
+    ArenaBlock *next;
+
+    if (block == NULL)
+    {
+        return;
+    }
+    while (block->next != NULL)
+    {
+        next = block->next;
+        free(block);
+        block = next;
+    }
+    block->used = 0;
+    arena->blocks = block;
+    arena->last = NULL;
+    arena->bytes = 0;
+}
+
+/* 
+ * Frees every block of the arena and leaves it empty and ready for reuse.
+ */
+void arena_free(Arena *arena)
+{
+    ArenaBlock *block = arena->blocks;
+    ArenaBlock *next;
+
+    while (block != NULL)
+    {
+        next = block->next;
+        free(block);
+        block = next;
+    }
+    arena_init(arena);
+}
@@ -0,0 +1,94 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_BLOCK_SIZE 65536 /* Default size of an arena block in bytes */
+
+/* 
+ * Structure to represent one block of memory owned by an arena.
+ * - next: Pointer to the previously allocated block.
+ * - size: Number of bytes available in the block.
+ * - used: Number of bytes already handed out from the block.
+ * The memory of the block follows this header.
+ */
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t size;
+    size_t used;
+} ArenaBlock;
+
+/* 
+ * Structure to represent an arena: a region that hands out memory with a pointer bump
+ * and releases everything at once.
+ * - blocks: Pointer to the current (most recent) block.
+ * - last: Pointer to the most recent allocation, which can be grown in place.
+ * - bytes: Total number of bytes handed out by the arena.
+ * - on_failure: Where to longjmp when a block cannot be allocated, or NULL to print an error
+ *   and exit. A caller that must survive running out of memory sets it around its allocations.
+ */
+typedef struct {
+    ArenaBlock *blocks;
+    void *last;
+    size_t bytes;
+    jmp_buf *on_failure;
+} Arena;
+
+/* 
+ * Initializes an empty arena.
+ * 
+ * @param arena: Pointer to the arena to initialize.
+ */
+void arena_init(Arena *arena);
+
+/* 
+ * Allocates memory from an arena. The memory is released by arena_free.
+ * If the memory cannot be allocated, jumps to arena->on_failure when it is set, otherwise
+ * prints an error and exits.
+ * 
+ * @param arena: Pointer to the arena.
+ * @param size: Number of bytes to allocate.
+ * @return: Pointer to the allocated memory.
+ */
+void *arena_alloc(Arena *arena, size_t size);
+
+/* 
+ * Grows an allocation of an arena, like realloc. The most recent allocation is grown
+ * in place when the current block has room, otherwise the contents are copied.
+ * 
+ * @param arena: Pointer to the arena.
+ * @param old: Pointer to the allocation to grow, or NULL.
+ * @param old_size: Current size of the allocation in bytes.
+ * @param new_size: Requested size of the allocation in bytes.
+ * @return: Pointer to the grown allocation.
+ */
+void *arena_grow(Arena *arena, void *old, size_t old_size, size_t new_size);
+
+/* 
+ * Duplicates a string into an arena.
+ * 
+ * @param arena: Pointer to the arena.
+ * @param str: The string to duplicate.
+ * @return: Pointer to the copy of the string.
+ */
+char *arena_strdup(Arena *arena, const char *str);
+
+/* 
+ * Releases all the memory of an arena but its first block, which is kept for the next use,
+ * so an arena that is reset after every file does not go back to malloc for small files.
+ * 
+ * @param arena: Pointer to the arena to reset.
+ */
+void arena_reset(Arena *arena);
+
+/* 
+ * Releases all the memory of an arena in one call.
+ * 
+ * @param arena: Pointer to the arena to free.
+ */
+void arena_free(Arena *arena);
+
+#endif /* ARENA_H */
@@ -0,0 +1,268 @@
+#define _POSIX_C_SOURCE 200809L /* open_memstream */
+
+#include "asm_library.h"
+#include "source_file.h"
+#include "pre_assembler.h"
+#include "first_pass.h"
+#include "second_pass.h"
+
+#define OUTPUT_STREAMS 4 /* Number of outputs of a source, each written to its own memory stream */
+
+/* 
+ * Structure to represent a context: the arena reset after every source instead of freed.
+ */
+struct asm_context {
+    Arena arena;
+};
+
+/* Leaves a result empty */
+static void clear_result(asm_result *result)
+{
+    result->object = NULL;
+    result->object_length = 0;
+    result->entries = NULL;
+    result->entries_length = 0;
+    result->externs = NULL;
+    result->externs_length = 0;
+    result->diagnostics = NULL;
+    result->diagnostics_length = 0;
+    result->expanded = NULL;
+    result->expanded_length = 0;
+    result->assembled = 0;
+    result->code_words = 0;
+    result->data_words = 0;
+}
+
+/* Releases one output of a result, which the source does not have */
+static void discard_output(char **buffer, size_t *length)
+{
+    free(*buffer);
+    *buffer = NULL;
+    *length = 0;
+}
+
+/*
+ * Opens a memory stream for every output of the result: the diagnostics, the object, the entries
+ * and the externs, in this order. Returns FALSE, with none of them open, if any cannot be opened.
+ */
+static Bool open_output_streams(asm_result *out, FILE *streams[OUTPUT_STREAMS])
+{
+    Bool opened = TRUE;
+    int i;
+
+    streams[0] = open_memstream(&out->diagnostics, &out->diagnostics_length);
+    streams[1] = open_memstream(&out->object, &out->object_length);
+    streams[2] = open_memstream(&out->entries, &out->entries_length);
+    streams[3] = open_memstream(&out->externs, &out->externs_length);
+    for (i = 0; i < OUTPUT_STREAMS; i++)
+    {
+        if (streams[i] == NULL)
+        {
+            opened = FALSE;
+        }
+    }
+    if (!opened)
+    {
+        for (i = 0; i < OUTPUT_STREAMS; i++)
+        {
+            if (streams[i] != NULL)
+            {
+                fclose(streams[i]);
+            }
+        }
+        asm_result_free(out);
+    }
+    return opened;
+}
+
+/*
+ * Closes the memory streams of the outputs, which hands their buffers to the result.
+ * Returns FALSE if any of them could not hold everything written to it.
+ */
+static Bool close_output_streams(FILE *streams[OUTPUT_STREAMS])
+{
+    Bool complete = TRUE;
+    int i;
+
+    for (i = 0; i < OUTPUT_STREAMS; i++)
+    {
+        if (ferror(streams[i]))
+        {
+            complete = FALSE;
+        }
+        if (fclose(streams[i]) != 0)
+        {
+            complete = FALSE;
+        }
+    }
+    return complete;
+}
+
+/* Releases the memory of a source, keeping the arena of a context for the next one */
+static void release_arena(asm_context *context, Arena *arena)
+{
+    arena->on_failure = NULL;
+    if (context != NULL)
+    {
+        arena_reset(arena);
+    }
+    else
+    {
+        arena_free(arena);
+    }
+}
+
+/* Assembles a source held in memory under the default name */
+int asm_assemble(const char *src, size_t len, asm_result *out)
+{
+    return asm_assemble_with(NULL, ASM_SOURCE_NAME, src, len, 0, out);
+}
+
+/*
+ * Assembles a source from memory the same way as process_file, with the outputs written to memory
+ * streams instead of files. The outputs that process_file would remove are discarded.
+ * The arena jumps back here when it runs out of memory, so the source is abandoned with
+ * ASM_SYSTEM_ERROR instead of exiting: only the variables set before setjmp are used then.
+ */
+int asm_assemble_with(asm_context *context, const char *name, const char *src, size_t len, int flags, asm_result *out)
+{
+    char *file_name;
+    Bool no_errors = TRUE;
+    Bool is_extern = TRUE;
+    int IC = 100;
+    int entry_count = 0;
+    SymbolTable labels;
+    ExternList externList;
+    InstructionArray instructionArray;
+    Program program;
+    EntryList *entryList;
+    DataSegment dataSegment;
+    ExpandedSource source;
+    SourceFile input;
+    Arena local_arena;
+    Arena *arena = context != NULL ? &context->arena : &local_arena;
+    FILE *streams[OUTPUT_STREAMS];
+    FILE *previous_errors;
+    jmp_buf on_failure;
+
+    clear_result(out);
+    if (!open_output_streams(out, streams))
+    {
+        return ASM_SYSTEM_ERROR;
+    }
+
+    /* The errors of this thread go to the diagnostics while the source is assembled */
+    previous_errors = errorStream();
+    setErrorStream(streams[0]);
+
+    if (context == NULL)
+    {
+        arena_init(arena);
+    }
+    arena->on_failure = &on_failure;
+    if (setjmp(on_failure) != 0)
+    {
+        setErrorStream(previous_errors);
+        release_arena(context, arena);
+        close_output_streams(streams);
+        asm_result_free(out);
+        return ASM_SYSTEM_ERROR;
+    }
+    file_name = arena_strdup(arena, name);
+    open_source_buffer(&input, src, len);
+    entryList = (EntryList *)arena_alloc(arena, sizeof(EntryList));
+    initSymbolTable(&labels, arena);
+    initEntryList(entryList, arena);
+    initExternList(&externList, arena);
+    init_instruction_array(&instructionArray, 2, arena);
+    init_program(&program, &labels, arena);
+    initDataSegment(&dataSegment, arena);
+    init_expanded_source(&source, arena);
+
+    if (macro_file(file_name, &input, arena, &source, FALSE))
+    {
+        /* The expanded source is returned instead of written to the .am file */
+        if ((flags & ASM_EMIT_EXPANDED) && (out->expanded = (char *)malloc(source.length + 1)) != NULL)
+        {
+            memcpy(out->expanded, source.text, source.length);
+            out->expanded[source.length] = '\0';
+            out->expanded_length = source.length;
+        }
+        out->assembled = 1;
+        no_errors = firstPass(&source, file_name, &IC, &labels, &externList, entryList, &dataSegment, &program);
+        secondPassToStreams(file_name, &IC, &labels, &externList, &entryList, &dataSegment, &instructionArray, &program,
+                            &no_errors, streams[1], streams[2], streams[3], &is_extern);
+        out->code_words = (int)instructionArray.size;
+        out->data_words = dataSegment.size;
+        entry_count = entryList->size;
+        if (IC > MAX_MOMMORY)
+        {
+            no_errors = FALSE;
+        }
+    }
+    else
+    {
+        fprintf(errorStream(), "Failed to process file: %s\n", file_name);
+        no_errors = FALSE;
+    }
+
+    setErrorStream(previous_errors);
+    close_source_file(&input);
+    release_arena(context, arena);
+    if (!close_output_streams(streams))
+    {
+        asm_result_free(out);
+        return ASM_SYSTEM_ERROR;
+    }
+
+    /* Keep the outputs the files of process_file would have */
+    if (!no_errors)
+    {
+        discard_output(&out->object, &out->object_length);
+    }
+    if (!no_errors || entry_count == 0)
+    {
+        discard_output(&out->entries, &out->entries_length);
+    }
+    if (!no_errors || is_extern)
+    {
+        discard_output(&out->externs, &out->externs_length);
+    }
+    return no_errors ? ASM_OK : ASM_SOURCE_ERRORS;
+}
+
+/* Creates a context with an empty arena */
+asm_context *asm_context_create(void)
+{
+    asm_context *context = (asm_context *)malloc(sizeof(asm_context));
+
+    if (context != NULL)
+    {
+        arena_init(&context->arena);
+    }
+    return context;
+}
+
+/* Releases a context with its arena */
+void asm_context_free(asm_context *context)
+{
+    arena_free(&context->arena);
+    free(context);
+}
+
+/* Releases the buffers of a result */
+void asm_result_free(asm_result *result)
+{
+    free(result->object);
+    free(result->entries);
+    free(result->externs);
+    free(result->diagnostics);
+    free(result->expanded);
+    clear_result(result);
+}
+
+/* Releases the macro definitions cached across sources */
+void asm_release_caches(void)
+{
+    free_definition_cache();
+}
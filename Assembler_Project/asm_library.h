@@ -0,0 +1,117 @@
+#ifndef ASM_LIBRARY_H
+#define ASM_LIBRARY_H
+
+#include <stddef.h>
+
+/*
+ * The in-memory API of the assembler, for programs that link it as a library (libasm.a).
+ * A source is assembled from a buffer and every output is returned in memory: nothing is read
+ * from or written to the file system. Several threads may assemble at the same time.
+ * Running out of memory abandons the source with ASM_SYSTEM_ERROR; it never exits the process.
+ */
+
+#define ASM_SOURCE_NAME "source" /* The file name the diagnostics of a source refer to */
+
+/* Results of asm_assemble */
+#define ASM_OK 0            /* The source was assembled without errors */
+#define ASM_SOURCE_ERRORS 1 /* The source has errors, they are listed in the diagnostics */
+#define ASM_SYSTEM_ERROR 2  /* The memory of the source or of its outputs ran out, out is left empty */
+
+/* Flags of asm_assemble_with */
+#define ASM_EMIT_EXPANDED 1 /* Also return the source after macro expansion, like --emit-am */
+
+/*
+ * A context that keeps the memory of one source for the next one, so a thread that assembles
+ * many sources allocates once. A context is used by one thread at a time.
+ */
+typedef struct asm_context asm_context;
+
+/*
+ * Structure to represent the outputs of one source, each one a NUL-terminated buffer
+ * allocated with malloc, or NULL when the source has no such output.
+ * - object: The object image, in the format of the .ob file. NULL if the source has errors.
+ * - object_length: The number of characters of the object image.
+ * - entries: The entry labels with their addresses, in the format of the .ent file.
+ *   NULL if the source has errors or declares no entry.
+ * - entries_length: The number of characters of the entries.
+ * - externs: The uses of extern labels with their addresses, in the format of the .ext file.
+ *   NULL if the source has errors or uses no extern label.
+ * - externs_length: The number of characters of the externs.
+ * - diagnostics: The error messages, one per line, as the assembler prints them. Never NULL
+ *   after asm_assemble returns ASM_OK or ASM_SOURCE_ERRORS, empty when there are none.
+ * - diagnostics_length: The number of characters of the diagnostics.
+ * - expanded: The source after macro expansion, in the format of the .am file. NULL unless
+ *   ASM_EMIT_EXPANDED was given and the macros were expanded without errors.
+ * - expanded_length: The number of characters of the expanded source.
+ * - assembled: 1 if the macros were expanded without errors and both passes ran. The outputs
+ *   that are NULL then stand for the files the assembler removes; otherwise it leaves them alone.
+ * - code_words: The number of words of the instructions.
+ * - data_words: The number of words of the data.
+ */
+typedef struct {
+    char *object;
+    size_t object_length;
+    char *entries;
+    size_t entries_length;
+    char *externs;
+    size_t externs_length;
+    char *diagnostics;
+    size_t diagnostics_length;
+    char *expanded;
+    size_t expanded_length;
+    int assembled;
+    int code_words;
+    int data_words;
+} asm_result;
+
+/*
+ * Assembles a source held in memory.
+ *
+ * @param src: The text of the source, which does not have to be NUL-terminated.
+ * @param len: The number of characters of the source.
+ * @param out: The result to fill; release it with asm_result_free.
+ * @return: ASM_OK, ASM_SOURCE_ERRORS or ASM_SYSTEM_ERROR.
+ */
+int asm_assemble(const char *src, size_t len, asm_result *out);
+
+/*
+ * Assembles a source held in memory, with the name its diagnostics refer to.
+ *
+ * @param context: The context to reuse, or NULL to allocate for this source only.
+ * @param name: The name of the source, as the base name of a file is given to the assembler.
+ * @param src: The text of the source, which does not have to be NUL-terminated.
+ * @param len: The number of characters of the source.
+ * @param flags: ASM_EMIT_EXPANDED or 0.
+ * @param out: The result to fill; release it with asm_result_free.
+ * @return: ASM_OK, ASM_SOURCE_ERRORS or ASM_SYSTEM_ERROR.
+ */
+int asm_assemble_with(asm_context *context, const char *name, const char *src, size_t len, int flags, asm_result *out);
+
+/*
+ * Creates a context for asm_assemble_with.
+ *
+ * @return: The context, or NULL if it cannot be allocated.
+ */
+asm_context *asm_context_create(void);
+
+/*
+ * Releases a context and the memory it keeps.
+ *
+ * @param context: The context to release.
+ */
+void asm_context_free(asm_context *context);
+
+/*
+ * Releases the buffers of a result and leaves it empty.
+ *
+ * @param result: The result to release.
+ */
+void asm_result_free(asm_result *result);
+
+/*
+ * Releases the macro definitions cached across the sources assembled so far.
+ * Must not be called while a source is being assembled.
+ */
+void asm_release_caches(void);
+
+#endif /* ASM_LIBRARY_H */
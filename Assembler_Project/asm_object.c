@@ -0,0 +1,116 @@
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "asm_object.h"
+
+/* Checks that a table of count records starts at an aligned offset and ends inside the data */
+static int table_fits(asm_u32 offset, asm_u32 count, size_t record_size, size_t size)
+{
+    return offset % ASM_OBJECT_ALIGNMENT == 0 && offset >= sizeof(asm_object_header) && offset <= size
+           && count <= (size - offset) / record_size;
+}
+
+/*
+ * Checks the header of an object in memory and points the tables of the object into it.
+ * Only the header is read: the tables are used as they are.
+ */
+int asm_object_view(const void *data, size_t size, asm_object *object)
+{
+    const asm_object_header *header = (const asm_object_header *)data;
+    const char *base = (const char *)data;
+
+    memset(object, 0, sizeof(asm_object));
+    if (size < sizeof(asm_object_header) || (size_t)base % ASM_OBJECT_ALIGNMENT != 0)
+    {
+        return ASM_OBJECT_INVALID;
+    }
+    if (memcmp(header->magic, ASM_OBJECT_MAGIC, sizeof(header->magic)) != 0
+        || header->byte_order != ASM_OBJECT_BYTE_ORDER || header->version != ASM_OBJECT_VERSION
+        || header->header_size != sizeof(asm_object_header) || header->file_size != size)
+    {
+        return ASM_OBJECT_INVALID;
+    }
+    if (header->code_words > (asm_u32)-1 - header->data_words
+        || !table_fits(header->words_offset, header->code_words + header->data_words, sizeof(asm_u16), size)
+        || !table_fits(header->entries_offset, header->entry_count, sizeof(asm_object_symbol), size)
+        || !table_fits(header->externs_offset, header->extern_count, sizeof(asm_object_symbol), size)
+        || !table_fits(header->relocations_offset, header->relocation_count, sizeof(asm_u32), size)
+        || !table_fits(header->strings_offset, header->strings_size, 1, size))
+    {
+        return ASM_OBJECT_INVALID;
+    }
+
+    /* Every name ends inside the strings */
+    if (header->strings_size > 0 && base[header->strings_offset + header->strings_size - 1] != '\0')
+    {
+        return ASM_OBJECT_INVALID;
+    }
+
+    object->header = header;
+    object->words = (const asm_u16 *)(base + header->words_offset);
+    object->entries = (const asm_object_symbol *)(base + header->entries_offset);
+    object->externs = (const asm_object_symbol *)(base + header->externs_offset);
+    object->relocations = (const asm_u32 *)(base + header->relocations_offset);
+    object->strings = base + header->strings_offset;
+    return ASM_OBJECT_OK;
+}
+
+/* Maps an object file read-only and checks it like asm_object_view */
+int asm_object_open(const char *path, asm_object *object)
+{
+    struct stat info;
+    void *mapping;
+    int result;
+    int fd = open(path, O_RDONLY);
+
+    memset(object, 0, sizeof(asm_object));
+    if (fd < 0)
+    {
+        return ASM_OBJECT_IO_ERROR;
+    }
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        close(fd);
+        return ASM_OBJECT_IO_ERROR;
+    }
+    if ((size_t)info.st_size < sizeof(asm_object_header))
+    {
+        close(fd);
+        return ASM_OBJECT_INVALID;
+    }
+    mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return ASM_OBJECT_IO_ERROR;
+    }
+
+    result = asm_object_view(mapping, info.st_size, object);
+    if (result != ASM_OBJECT_OK)
+    {
+        munmap(mapping, info.st_size);
+        return result;
+    }
+    object->mapping = mapping;
+    object->mapping_size = info.st_size;
+    return ASM_OBJECT_OK;
+}
+
+/* Gets the name of a symbol from the strings, checking its offset */
+const char *asm_object_symbol_name(const asm_object *object, const asm_object_symbol *symbol)
+{
+    return symbol->name < object->header->strings_size ? object->strings + symbol->name : NULL;
+}
+
+/* Unmaps the file of an object */
+void asm_object_close(asm_object *object)
+{
+    if (object->mapping != NULL)
+    {
+        munmap(object->mapping, object->mapping_size);
+    }
+    memset(object, 0, sizeof(asm_object));
+}
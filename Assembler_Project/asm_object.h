@@ -0,0 +1,143 @@
+#ifndef ASM_OBJECT_H
+#define ASM_OBJECT_H
+
+#include <stddef.h>
+
+/*
+ * The packed binary object format (the .obj file written with --binary) and a reader that maps it.
+ * Every record has a fixed size and every table starts at an offset given in the header, aligned
+ * to 4 bytes, so a mapped file is used in place: nothing is parsed or copied.
+ *
+ * Layout of a file:
+ * - header: an asm_object_header;
+ * - words: code_words + data_words 16-bit words, the code image from base_address followed by
+ *   the data image, each word holding the 15 bits of the .ob file;
+ * - entries: entry_count asm_object_symbol records, the .ent file in order;
+ * - externs: extern_count asm_object_symbol records, one per use of an extern label, the .ext file in order;
+ * - relocations: relocation_count addresses of the code words that hold the address of a label of
+ *   the file (ARE relocatable), to adjust when the program is loaded elsewhere than base_address;
+ * - strings: the NUL-terminated names the symbols refer to.
+ * Numbers are in the byte order of the machine that wrote the file, which byte_order records;
+ * the reader rejects a file of the other order.
+ */
+
+/* Fixed-width numbers of the format */
+typedef unsigned short asm_u16;
+typedef unsigned int asm_u32;
+typedef char asm_u16_size_check[sizeof(asm_u16) == 2 ? 1 : -1];
+typedef char asm_u32_size_check[sizeof(asm_u32) == 4 ? 1 : -1];
+
+#define ASM_OBJECT_MAGIC "ASMO"            /* First 4 bytes of every file */
+#define ASM_OBJECT_BYTE_ORDER 0x01020304UL /* byte_order as written, reads differently in the other order */
+#define ASM_OBJECT_VERSION 1               /* Version of the format described here */
+#define ASM_OBJECT_ALIGNMENT 4             /* Alignment of every table */
+
+/* Results of asm_object_open and asm_object_view */
+#define ASM_OBJECT_OK 0          /* The object is ready to use */
+#define ASM_OBJECT_IO_ERROR 1    /* The file cannot be opened or mapped */
+#define ASM_OBJECT_INVALID 2     /* The data is not an object of this format and byte order */
+
+/*
+ * Structure to represent the header at the start of a file.
+ * - magic: ASM_OBJECT_MAGIC, without a terminating NUL.
+ * - byte_order: ASM_OBJECT_BYTE_ORDER.
+ * - version: ASM_OBJECT_VERSION.
+ * - header_size: The size of the header, sizeof(asm_object_header).
+ * - base_address: The address of the first code word.
+ * - code_words: The number of words of the code image.
+ * - data_words: The number of words of the data image, which follows the code image.
+ * - entry_count, extern_count, relocation_count: The number of records of each table.
+ * - words_offset, entries_offset, externs_offset, relocations_offset, strings_offset: The offset of
+ *   each table from the start of the file.
+ * - strings_size: The number of bytes of the names, including their terminating NULs.
+ * - file_size: The size of the whole file.
+ */
+typedef struct {
+    char magic[4];
+    asm_u32 byte_order;
+    asm_u16 version;
+    asm_u16 header_size;
+    asm_u32 base_address;
+    asm_u32 code_words;
+    asm_u32 data_words;
+    asm_u32 entry_count;
+    asm_u32 extern_count;
+    asm_u32 relocation_count;
+    asm_u32 words_offset;
+    asm_u32 entries_offset;
+    asm_u32 externs_offset;
+    asm_u32 relocations_offset;
+    asm_u32 strings_offset;
+    asm_u32 strings_size;
+    asm_u32 file_size;
+} asm_object_header;
+
+/*
+ * Structure to represent an entry or a use of an extern label.
+ * - name: The offset of the name of the label in the strings.
+ * - address: The address of the entry label, or of the word that uses the extern label.
+ */
+typedef struct {
+    asm_u32 name;
+    asm_u32 address;
+} asm_object_symbol;
+
+/*
+ * Structure to represent an object opened by the reader; every pointer points into the file.
+ * - header: The header of the file.
+ * - words: The code words followed by the data words.
+ * - entries: The entries.
+ * - externs: The uses of extern labels.
+ * - relocations: The addresses of the relocatable words.
+ * - strings: The names of the symbols.
+ * - mapping: The mapping of the file, NULL for an object viewed in a buffer of the caller.
+ * - mapping_size: The size of the mapping.
+ */
+typedef struct {
+    const asm_object_header *header;
+    const asm_u16 *words;
+    const asm_object_symbol *entries;
+    const asm_object_symbol *externs;
+    const asm_u32 *relocations;
+    const char *strings;
+    void *mapping;
+    size_t mapping_size;
+} asm_object;
+
+/*
+ * Maps an object file and checks its header and the bounds of its tables.
+ *
+ * @param path: The path of the .obj file.
+ * @param object: The object to fill; release it with asm_object_close.
+ * @return: ASM_OBJECT_OK, ASM_OBJECT_IO_ERROR or ASM_OBJECT_INVALID.
+ */
+int asm_object_open(const char *path, asm_object *object);
+
+/*
+ * Uses an object already in memory, with the same checks as asm_object_open.
+ * The data must stay valid and be aligned to ASM_OBJECT_ALIGNMENT while the object is used.
+ *
+ * @param data: The contents of an object file.
+ * @param size: The number of bytes of the contents.
+ * @param object: The object to fill.
+ * @return: ASM_OBJECT_OK or ASM_OBJECT_INVALID.
+ */
+int asm_object_view(const void *data, size_t size, asm_object *object);
+
+/*
+ * Gets the name of an entry or of an extern label.
+ *
+ * @param object: The object the symbol belongs to.
+ * @param symbol: The symbol.
+ * @return: The name, or NULL if the symbol points outside the strings.
+ */
+const char *asm_object_symbol_name(const asm_object *object, const asm_object_symbol *symbol);
+
+/*
+ * Unmaps an object opened by asm_object_open. Does nothing for an object viewed in memory.
+ *
+ * @param object: The object to release.
+ */
+void asm_object_close(asm_object *object);
+
+#endif /* ASM_OBJECT_H */
@@ -2,6 +2,19 @@
 
 /* 
 	Processes the given file(s) by calling the appropriate functions.
+	The option --emit-am also writes the source of each file after macro expansion to <name>.am.
+	The option -j N assembles the files concurrently on N worker threads.
+	The option --cache DIR keeps the outputs of every file in DIR, keyed on the contents of its
+	source, and restores them instead of assembling the file again when the source has not changed.
+	The option --stats reports the time of each stage and the counters of every file on stdout,
+	as text, or as one JSON object per line with --stats=json.
+	The option --serve SOCKET runs the assembler as a server on a Unix domain socket (with -j N workers),
+	and --connect SOCKET assembles the given files on that server instead of in this process.
+	The option --stdout writes the object of every file to stdout instead of its .ob file, and
+	--stdout=sections writes every output as a framed section. The file - is read from stdin,
+	and its outputs always go to stdout, so without --stdout it must be the only file.
+	-j is not supported when the outputs go to stdout.
+	The option --binary also writes the object of every file in the packed binary format to <name>.obj.
 	If no files are provided, the program will terminate with an error message.
 */
 
@@ -9,68 +22,338 @@
 int main(int argc, char *argv[])
 {    
     	int i;
+	int file_count = 0;
+	int jobs = 1;
+	Bool jobs_given = FALSE;
+	Bool stdin_given = FALSE;
+	const char *serve_path = NULL;
+	const char *connect_path = NULL;
+	AssemblerOptions options;
+	char **files = (char **)malloc(argc * sizeof(char *));
+
+	if (files == NULL)
+	{
+		fprintf(stderr, "Unable to allocate memory for file names\n");
+		return 1;
+	}
+	options.emit_am = FALSE;
+	options.cache_dir = NULL;
+	options.stats = STATS_NONE;
+	options.to_stdout = STDOUT_NONE;
+	options.binary = FALSE;
+
+	/* Read the options, every other argument is a file */
+	for(i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--emit-am") == 0)
+		{
+			options.emit_am = TRUE;
+		}
+		else if (strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--stats=text") == 0)
+		{
+			options.stats = STATS_TEXT;
+		}
+		else if (strcmp(argv[i], "--stats=json") == 0)
+		{
+			options.stats = STATS_JSON;
+		}
+		else if (strcmp(argv[i], "--binary") == 0)
+		{
+			options.binary = TRUE;
+		}
+		else if (strcmp(argv[i], "--stdout") == 0 || strcmp(argv[i], "--stdout=object") == 0)
+		{
+			options.to_stdout = STDOUT_OBJECT;
+		}
+		else if (strcmp(argv[i], "--stdout=sections") == 0)
+		{
+			options.to_stdout = STDOUT_SECTIONS;
+		}
+		else if (strcmp(argv[i], "--cache") == 0)
+		{
+			/* The directory follows the option */
+			if (i + 1 >= argc)
+			{
+				fprintf(stderr, "Error: --cache needs a directory\n");
+				free(files);
+				return 1;
+			}
+			options.cache_dir = argv[++i];
+		}
+		else if (strcmp(argv[i], "--serve") == 0 || strcmp(argv[i], "--connect") == 0)
+		{
+			/* The socket follows the option */
+			if (i + 1 >= argc)
+			{
+				fprintf(stderr, "Error: %s needs a socket path\n", argv[i]);
+				free(files);
+				return 1;
+			}
+			if (strcmp(argv[i], "--serve") == 0)
+			{
+				serve_path = argv[++i];
+			}
+			else
+			{
+				connect_path = argv[++i];
+			}
+		}
+		else if (strncmp(argv[i], "-j", 2) == 0)
+		{
+			/* The number of jobs follows the option, either attached (-j4) or as the next argument, and is all digits */
+			const char *value = argv[i][2] != '\0' ? argv[i] + 2 : (i + 1 < argc ? argv[++i] : "");
+			char *end;
+			long count;
+
+			errno = 0;
+			count = strtol(value, &end, 10);
+			if (value[0] < '0' || value[0] > '9' || *end != '\0' || errno == ERANGE || count < 1 || count > INT_MAX)
+			{
+				fprintf(stderr, "Error: -j needs a positive number of jobs\n");
+				free(files);
+				return 1;
+			}
+			jobs = (int)count;
+			jobs_given = TRUE;
+		}
+		else
+		{
+			if (strcmp(argv[i], STDIN_ARGUMENT) == 0)
+			{
+				stdin_given = TRUE;
+			}
+			files[file_count++] = argv[i];
+		}
+	}
 	
+	/* The server takes its files from its clients */
+	if (serve_path != NULL)
+	{
+		free(files);
+		if (file_count > 0 || connect_path != NULL)
+		{
+			fprintf(stderr, "Error: --serve does not take files\n");
+			return 1;
+		}
+		return run_server(serve_path, jobs_given ? jobs : DEFAULT_SERVER_WORKERS);
+	}
+
+	/* 
+		The standard input has no file for its outputs, so they go to stdout. The outputs of the
+		named files only go there too when --stdout asks for it.
+	*/
+	if (stdin_given && options.to_stdout == STDOUT_NONE)
+	{
+		if (file_count > 1)
+		{
+			fprintf(stderr, "Error: - cannot be mixed with other files without --stdout\n");
+			free(files);
+			return 1;
+		}
+		options.to_stdout = STDOUT_OBJECT;
+	}
+
+	/* The binary object is only written next to the source */
+	if (options.binary && (options.cache_dir != NULL || connect_path != NULL || options.to_stdout != STDOUT_NONE))
+	{
+		fprintf(stderr, "Error: --binary does not support --cache, --connect, --stdout or -\n");
+		free(files);
+		return 1;
+	}
+
     	/* 
 			Check if there are any files to read from.
 			If no files are provided, print an error message and exit.
 		*/
-    	if(argc < 2)
+    	if(file_count == 0)
     	{
         	fprintf(stderr, "Error: there is no file to read from\n");
+		free(files);
         	return 1;
     	}
 
     	/* 
-			Iterate through all provided files and process each one.
+			Process each provided file, one after the other, on the worker pool or on a server.
 		*/
-    	for(i = 1; i < argc; i++)
-    	{	
-        	process_file(argv[i]);
-    	}
+	if (options.to_stdout != STDOUT_NONE)
+	{
+		if (options.cache_dir != NULL || options.stats != STATS_NONE || connect_path != NULL || jobs_given)
+		{
+			fprintf(stderr, "Error: --stdout and - do not support --cache, --stats, --connect or -j\n");
+			free(files);
+			return 1;
+		}
+		if (options.emit_am && options.to_stdout != STDOUT_SECTIONS)
+		{
+			fprintf(stderr, "Error: --emit-am needs --stdout=sections to write the expanded source to stdout\n");
+			free(files);
+			return 1;
+		}
+		i = assemble_files_to_stdout(files, file_count, &options);
+		free(files);
+		return i;
+	}
+	if (connect_path != NULL)
+	{
+		if (options.cache_dir != NULL || options.stats != STATS_NONE)
+		{
+			fprintf(stderr, "Error: --connect does not support --cache or --stats\n");
+			free(files);
+			return 1;
+		}
+		i = assemble_files_remote(connect_path, files, file_count, &options);
+		free(files);
+		return i;
+	}
+	if (jobs > 1 && file_count > 1)
+	{
+		assemble_files_parallel(files, file_count, jobs, &options);
+	}
+	else
+	{
+    		for(i = 0; i < file_count; i++)
+    		{	
+        		process_file(files[i], &options);
+    		}
+	}
     	
 		/* 
 			Program completed successfully.
 		*/
+	free_definition_cache();
+	free(files);
     	return 0;
 }
 
 /* 
 	Processes a single file by performing the first and second passes over it.
+	The source after macro expansion is kept in memory and handed to the first pass;
+	it is written to the .am file only when options->emit_am is TRUE.
+	With a cache directory, a source that was assembled before is not assembled again: its outputs
+	are restored from the cache. A source that assembles without errors is stored in the cache.
 	Initializes necessary structures and checks for errors during processing.
+	All the structures of the file allocate from one arena, which is released in one call
+	at the end, whether the file was assembled or not.
+	With options->stats, the stages are timed and the statistics are written to the output stream.
 	If macro_file processing fails, an error message is printed and the function returns early.
 */
-void process_file(char *file_name)
+void process_file(char *file_name, const AssemblerOptions *options)
 {
 		Bool no_errors = TRUE;
 		int IC = 100;
-		int DC = 0;
-		LabelNode* labels = NULL;
+		SymbolTable labels;
 		ExternList externList;
 		InstructionArray instructionArray;
-		Node* label_list_used = NULL;
-		EntryList* entryList = (EntryList*)malloc(sizeof(EntryList));
-		Data* head = NULL;
-		CharData* headChar = NULL;
+		Program program;
+		EntryList* entryList;
+		DataSegment dataSegment;
+		ExpandedSource source;
+		SourceFile input;
+		char *input_file_name;
+		Arena arena;
+		FileStats stats;
+		double start;
+
+		/* Open the source file */
+		init_file_stats(&stats);
+		arena_init(&arena);
+		input_file_name = (char*)arena_alloc(&arena, strlen(file_name) + END_OF_FILE + 1);
+		my_snprintf(input_file_name, strlen(file_name) + END_OF_FILE + 1, "%s%s", file_name, ".as");
+		if (!open_source_file(&input, input_file_name))
+		{
+				fprintf(errorStream(), "Error opening input file: %s\n", input_file_name);
+				fprintf(errorStream(), "Failed to process file: %s\n", file_name);
+				arena_free(&arena);
+				return;
+		}
+
+		/* Restore the outputs of a source that was assembled before */
+		if (options->cache_dir != NULL && cache_restore(options->cache_dir, file_name, input.data, input.size, options->emit_am))
+		{
+				if (options->stats != STATS_NONE)
+				{
+						stats.cached = TRUE;
+						stats.bytes_allocated = arena.bytes;
+						print_file_stats(outputStream(), file_name, &stats, options->stats);
+				}
+				close_source_file(&input);
+				arena_free(&arena);
+				return;
+		}
 
 		/* Initialize the lists and instruction array */
-		initEntryList(entryList);
-		initExternList(&externList);
-		init_instruction_array(&instructionArray, 2);
+		entryList = (EntryList*)arena_alloc(&arena, sizeof(EntryList));
+		initSymbolTable(&labels, &arena);
+		initEntryList(entryList, &arena);
+		initExternList(&externList, &arena);
+		init_instruction_array(&instructionArray, 2, &arena);
+		init_program(&program, &labels, &arena);
+		initDataSegment(&dataSegment, &arena);
+		init_expanded_source(&source, &arena);
 
 		/* 
 			Check if the file contains macros and process it if true.
 			Perform the first pass and then the second pass over the file.
 		*/
-		if (macro_file(file_name))
+		start = options->stats != STATS_NONE ? stats_clock() : 0;
+		if (macro_file(file_name, &input, &arena, &source, options->emit_am))
 		{
-				no_errors = openfileFirstPast(file_name, &IC, &DC, &labels, &externList, entryList, &head, &headChar, &instructionArray, &label_list_used);
-				secondPass(file_name, &IC, &DC, &labels, &externList, &entryList, &head, &headChar, &instructionArray, &label_list_used, &no_errors);
+				if (options->stats != STATS_NONE)
+				{
+						stats.pre_assembly = stats_clock() - start;
+						start = stats_clock();
+				}
+				no_errors = firstPass(&source, file_name, &IC, &labels, &externList, entryList, &dataSegment, &program);
+				if (options->stats != STATS_NONE)
+				{
+						stats.first_pass = stats_clock() - start;
+						stats.labels_defined = labels.size;
+						stats.references_patched = program.reference_count;
+						start = stats_clock();
+				}
+				secondPass(file_name, &IC, &labels, &externList, &entryList, &dataSegment, &instructionArray, &program, &no_errors);
+				if (options->stats != STATS_NONE)
+				{
+						stats.second_pass = stats_clock() - start;
+						stats.words_emitted = (long)instructionArray.size + dataSegment.size;
+				}
+				if (options->binary)
+				{
+						if (!write_binary_object_file(file_name, no_errors && IC <= MAX_MOMMORY ? TRUE : FALSE, &labels, entryList,
+						                              &dataSegment, &instructionArray, &program))
+						{
+								no_errors = FALSE;
+						}
+				}
+
+				/* Keep the outputs of a file that assembled without errors */
+				if (options->cache_dir != NULL && no_errors && IC <= MAX_MOMMORY)
+				{
+						cache_store(options->cache_dir, file_name, input.data, input.size, options->emit_am);
+				}
 		}
 		else
 		{
+				if (options->stats != STATS_NONE)
+				{
+						stats.pre_assembly = stats_clock() - start;
+				}
+
 				/* Print an error message if the file processing fails */
-				fprintf(stderr, "Failed to process file: %s\n", file_name);
-				return;
+				fprintf(errorStream(), "Failed to process file: %s\n", file_name);
+		}
+
+		/* Report the statistics of the file */
+		if (options->stats != STATS_NONE)
+		{
+				stats.lines_read = source.lines_read;
+				stats.macros_expanded = source.macro_calls;
+				stats.bytes_allocated = arena.bytes;
+				print_file_stats(outputStream(), file_name, &stats, options->stats);
 		}
+
+		/* Release the source and everything the file allocated */
+		close_source_file(&input);
+		arena_free(&arena);
 }
 
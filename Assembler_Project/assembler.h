@@ -1,6 +1,8 @@
 #ifndef ASSEMBLER_H
 #define ASSEMBLER_H
 
+#include <errno.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -10,12 +12,21 @@
 #include "first_pass.h"
 #include "label.h"
 #include "second_pass.h"
+#include "worker_pool.h"
+#include "output_cache.h"
+#include "stats.h"
+#include "server.h"
+#include "stdio_mode.h"
+#include "binary_object.h"
 
 /* 
-	Processes the given file(s) by calling the appropriate functions.
-	If no files are provided, the program will terminate with an error message.
+	Processes a single file by performing the first and second passes over it.
+	If options->emit_am is TRUE, the source after macro expansion is also written to <name>.am.
+	If options->cache_dir is set, the outputs are restored from the cache when the source is unchanged.
+	If options->stats is set, the times of the stages and the counters of the file are reported.
+	If options->binary is TRUE, the packed binary object is also written to <name>.obj.
 */
-void process_file(char *file_name);
+void process_file(char *file_name, const AssemblerOptions *options);
 
 /* 
 	Main function that serves as the entry point for the program.
@@ -0,0 +1,170 @@
+/* 
+ * Microbenchmark of the character class scanner.
+ * The given source files are repeated until the text reaches the requested size. Then, with
+ * every implementation of the scanner the processor supports, the text is:
+ * - tokenized line by line, the way the first pass does;
+ * - scanned from end to end for the quotes and commas, which leaves long spans between matches.
+ * Prints the throughput of both in megabytes per second.
+ *
+ * Usage: char_class_bench [-s megabytes] file.as...
+ */
+#include <time.h>
+
+#include "../general_functions.h"
+#include "../pre_assembler.h"
+#include "../char_class.h"
+
+#define DEFAULT_MEGABYTES 64 /* Default size of the scaled up text */
+#define REPEATS 3            /* Number of runs of every implementation, the best one is kept */
+
+/* Reads a whole file and appends it to the text */
+static void append_file(const char *path, char **text, size_t *length, size_t *capacity)
+{
+    FILE *file = fopen(path, "rb");
+    size_t count;
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening input file: %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    do
+    {
+        if (*length == *capacity)
+        {
+            *capacity = *capacity == 0 ? 65536 : *capacity * 2;
+            *text = realloc(*text, *capacity);
+            if (*text == NULL)
+            {
+                fprintf(stderr, "Unable to allocate memory for the text\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        count = fread(*text + *length, 1, *capacity - *length, file);
+        *length += count;
+    } while (count > 0);
+    fclose(file);
+}
+
+/* Tokenizes every line of the text and returns the number of tokens, so the work is not optimized away */
+static long tokenize_text(const char *text, size_t length)
+{
+    const char *cursor = text;
+    const char *end = text + length;
+    char line[MAX_LINE_LENGTH + 2];
+    TokenList tokens;
+    long count = 0;
+
+    while (readSourceLine(&cursor, end, line, sizeof(line)))
+    {
+        count += tokenizeLine(line, &tokens);
+    }
+    return count;
+}
+
+/* Scans the whole text for quotes and commas and returns the number of matches */
+static long scan_text(const char *text, size_t length)
+{
+    const char *end = text + length;
+    long count = 0;
+
+    text = scan_to_class(text, end, CHAR_QUOTE | CHAR_COMMA);
+    while (text != end)
+    {
+        count++;
+        text = scan_to_class(text + 1, end, CHAR_QUOTE | CHAR_COMMA);
+    }
+    return count;
+}
+
+/* Runs a measurement a few times and returns the shortest time in seconds */
+static double best_time(long (*measure)(const char *, size_t), const char *text, size_t length, long *result)
+{
+    double best = 0;
+    double seconds;
+    clock_t start;
+    int run;
+
+    for (run = 0; run < REPEATS; run++)
+    {
+        start = clock();
+        *result = measure(text, length);
+        seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        if (run == 0 || seconds < best)
+        {
+            best = seconds;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char *argv[])
+{
+    static const CharClassImpl impls[] = { CHAR_CLASS_SCALAR, CHAR_CLASS_SSE2, CHAR_CLASS_AVX2 };
+    char *corpus = NULL;
+    size_t corpus_length = 0;
+    size_t corpus_capacity = 0;
+    char *text;
+    size_t length = 0;
+    size_t target;
+    long megabytes = DEFAULT_MEGABYTES;
+    long tokens;
+    long matches;
+    double tokenize_seconds;
+    double scan_seconds;
+    int first = 1;
+    int i;
+
+    if (argc > 2 && strcmp(argv[1], "-s") == 0)
+    {
+        megabytes = atol(argv[2]);
+        first = 3;
+    }
+    if (first >= argc || megabytes < 1)
+    {
+        fprintf(stderr, "Usage: %s [-s megabytes] file.as...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (i = first; i < argc; i++)
+    {
+        append_file(argv[i], &corpus, &corpus_length, &corpus_capacity);
+    }
+    if (corpus_length == 0)
+    {
+        fprintf(stderr, "The input files are empty\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Scale the corpus up by repeating it */
+    target = (size_t)megabytes * 1024 * 1024;
+    text = malloc(target + corpus_length);
+    if (text == NULL)
+    {
+        fprintf(stderr, "Unable to allocate memory for the text\n");
+        return EXIT_FAILURE;
+    }
+    while (length < target)
+    {
+        memcpy(text + length, corpus, corpus_length);
+        length += corpus_length;
+    }
+
+    printf("%lu bytes from %d files, repeated to %lu bytes\n",
+           (unsigned long)corpus_length, argc - first, (unsigned long)length);
+    for (i = 0; i < (int)(sizeof(impls) / sizeof(impls[0])); i++)
+    {
+        if (!use_char_class_impl(impls[i]))
+        {
+            continue;
+        }
+        tokenize_seconds = best_time(tokenize_text, text, length, &tokens);
+        scan_seconds = best_time(scan_text, text, length, &matches);
+        printf("%-6s tokenize %8.1f MB/s (%ld tokens)  scan %8.1f MB/s (%ld matches)\n", char_class_impl_name(),
+               length / tokenize_seconds / 1e6, tokens, length / scan_seconds / 1e6, matches);
+    }
+
+    free(text);
+    free(corpus);
+    return EXIT_SUCCESS;
+}
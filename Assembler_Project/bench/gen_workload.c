@@ -0,0 +1,333 @@
+/*
+ * Generator of synthetic assembly programs for the benchmarks.
+ * Writes a valid program to the standard output, built from:
+ * - macros with a few instructions each, called in place of some instructions;
+ * - instructions of every operation with random operands of the modes the operation allows;
+ * - .data and .string directives mixed between the instructions;
+ * - labels spread evenly over the instructions and directives, some of them declared .entry;
+ * - .extern symbols that a share of the label operands refer to.
+ * The same options and seed always give the same program. A program of more than about 1000
+ * instructions does not fit in memory; it is still processed by every stage, which then reports it.
+ *
+ * Usage: gen_workload [-n instructions] [-l labels] [-k macros] [-d directives] [-x extern] [-e entry] [-p percent] [-r seed]
+ *   -n  Number of instruction lines, counting each macro call as one (default 1000).
+ *   -l  Number of labels (default 100).
+ *   -k  Number of macros; every tenth instruction line is a call when there are any (default 10).
+ *   -d  Number of .data and .string directives per 100 instruction lines, half of each (default 20).
+ *   -x  Percentage of the label operands that refer to .extern symbols (default 10).
+ *   -e  Percentage of the labels that are declared .entry (default 10).
+ *   -p  Percentage of the operands that are labels when their operation allows one (default: every
+ *       allowed mode is equally likely). With -p 100 every such operand is a label reference.
+ *   -r  Seed of the random choices (default 1).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MACRO_BODY_LINES 4 /* Number of instructions in the body of each macro */
+#define MACRO_CALL_EVERY 10 /* Every this many instruction lines, one is a macro call */
+#define EXTERN_SYMBOLS 16   /* Number of .extern symbols declared when any operand refers to one */
+#define MAX_DATA_NUMBERS 6  /* Maximum count of numbers in a .data directive */
+#define MAX_STRING_LENGTH 12 /* Maximum length of a .string directive */
+
+/* Bits of the operand addressing modes, as in the operation table */
+#define MODE_IMMEDIATE 1 /* #number */
+#define MODE_DIRECT 2    /* label */
+#define MODE_INDIRECT 4  /* *register */
+#define MODE_REGISTER 8  /* register */
+#define MODE_ANY (MODE_IMMEDIATE | MODE_DIRECT | MODE_INDIRECT | MODE_REGISTER)
+#define MODE_WRITABLE (MODE_DIRECT | MODE_INDIRECT | MODE_REGISTER)
+#define MODE_JUMP (MODE_DIRECT | MODE_INDIRECT)
+
+/*
+ * Structure to represent an operation and the addressing modes of its operands.
+ * - name: The name of the operation.
+ * - source_modes: The modes allowed for the source operand, 0 if there is none.
+ * - dest_modes: The modes allowed for the destination operand, 0 if there is none.
+ */
+typedef struct {
+    const char *name;
+    int source_modes;
+    int dest_modes;
+} GeneratedOperation;
+
+static const GeneratedOperation operations[] = {
+    { "mov", MODE_ANY, MODE_WRITABLE },
+    { "cmp", MODE_ANY, MODE_ANY },
+    { "add", MODE_ANY, MODE_WRITABLE },
+    { "sub", MODE_ANY, MODE_WRITABLE },
+    { "lea", MODE_DIRECT, MODE_WRITABLE },
+    { "clr", 0, MODE_WRITABLE },
+    { "not", 0, MODE_WRITABLE },
+    { "inc", 0, MODE_WRITABLE },
+    { "dec", 0, MODE_WRITABLE },
+    { "jmp", 0, MODE_JUMP },
+    { "bne", 0, MODE_JUMP },
+    { "red", 0, MODE_WRITABLE },
+    { "prn", 0, MODE_ANY },
+    { "jsr", 0, MODE_JUMP },
+    { "rts", 0, 0 },
+    { "stop", 0, 0 }
+};
+
+#define OPERATION_TOTAL (int)(sizeof(operations) / sizeof(operations[0]))
+
+/*
+ * Structure to represent the options of the generated program, see the usage above.
+ */
+typedef struct {
+    long instructions;
+    long labels;
+    long macros;
+    long directives;
+    long extern_percent;
+    long entry_percent;
+    long label_percent;
+    unsigned long seed;
+} WorkloadOptions;
+
+static unsigned long random_state; /* State of the random number generator */
+
+/* Returns a random number from 0 to limit-1 (a linear congruential generator, the same on every platform) */
+static long random_below(long limit)
+{
+    random_state = random_state * 1103515245UL + 12345UL;
+    return (long)((random_state >> 16) & 0x7FFF) % limit;
+}
+
+/* Writes an operand of one of the given modes, a label only when there are labels to refer to */
+static void write_operand(int modes, const WorkloadOptions *options)
+{
+    int choices[4];
+    int count = 0;
+    int mode;
+
+    if (modes & MODE_IMMEDIATE) choices[count++] = MODE_IMMEDIATE;
+    if ((modes & MODE_DIRECT) && (options->labels > 0 || options->extern_percent > 0)) choices[count++] = MODE_DIRECT;
+    if (modes & MODE_INDIRECT) choices[count++] = MODE_INDIRECT;
+    if (modes & MODE_REGISTER) choices[count++] = MODE_REGISTER;
+
+    /* A label operand is chosen first when its share is given */
+    if (options->label_percent >= 0 && count > 1)
+    {
+        if ((modes & MODE_DIRECT) && (options->labels > 0 || options->extern_percent > 0)
+            && random_below(100) < options->label_percent)
+        {
+            mode = MODE_DIRECT;
+        }
+        else
+        {
+            do
+            {
+                mode = choices[random_below(count)];
+            } while (mode == MODE_DIRECT);
+        }
+    }
+    else
+    {
+        mode = choices[random_below(count)];
+    }
+    switch (mode)
+    {
+        case MODE_IMMEDIATE:
+            printf("#%ld", random_below(2001) - 1000);
+            break;
+        case MODE_DIRECT:
+            if (options->labels == 0 || random_below(100) < options->extern_percent)
+            {
+                printf("X%ld", random_below(EXTERN_SYMBOLS));
+            }
+            else
+            {
+                printf("L%ld", random_below(options->labels));
+            }
+            break;
+        case MODE_INDIRECT:
+            printf("*r%ld", random_below(8));
+            break;
+        default:
+            printf("r%ld", random_below(8));
+            break;
+    }
+}
+
+/* Writes a random instruction, without a label or a newline */
+static void write_instruction(const WorkloadOptions *options)
+{
+    const GeneratedOperation *operation;
+
+    /* lea needs a label, so it is left out of programs without any */
+    do
+    {
+        operation = &operations[random_below(OPERATION_TOTAL)];
+    } while (operation->source_modes == MODE_DIRECT && options->labels == 0 && options->extern_percent == 0);
+
+    printf("%s", operation->name);
+    if (operation->source_modes != 0)
+    {
+        printf(" ");
+        write_operand(operation->source_modes, options);
+        printf(",");
+    }
+    if (operation->dest_modes != 0)
+    {
+        printf(" ");
+        write_operand(operation->dest_modes, options);
+    }
+}
+
+/* Writes a random .data or .string directive, without a label or a newline */
+static void write_directive(long index)
+{
+    long count;
+    long i;
+
+    if (index % 2 == 0)
+    {
+        printf(".data ");
+        count = 1 + random_below(MAX_DATA_NUMBERS);
+        for (i = 0; i < count; i++)
+        {
+            printf(i == 0 ? "%ld" : ", %ld", random_below(2001) - 1000);
+        }
+    }
+    else
+    {
+        printf(".string \"");
+        count = 1 + random_below(MAX_STRING_LENGTH);
+        for (i = 0; i < count; i++)
+        {
+            putchar('a' + (int)random_below(26));
+        }
+        printf("\"");
+    }
+}
+
+/* Parses a non-negative number option, exits with the usage on an invalid one */
+static long parse_count(const char *text, const char *program)
+{
+    char *end;
+    long value = strtol(text, &end, 10);
+
+    if (*text == '\0' || *end != '\0' || value < 0)
+    {
+        fprintf(stderr, "Usage: %s [-n instructions] [-l labels] [-k macros] [-d directives] [-x extern] [-e entry] [-p percent] [-r seed]\n", program);
+        exit(EXIT_FAILURE);
+    }
+    return value;
+}
+
+int main(int argc, char *argv[])
+{
+    WorkloadOptions options;
+    long statements;
+    long directive_count;
+    long label_every;
+    long statement;
+    long instruction = 0;
+    long directive = 0;
+    long label = 0;
+    int labeled;
+    long i;
+    long j;
+
+    options.instructions = 1000;
+    options.labels = 100;
+    options.macros = 10;
+    options.directives = 20;
+    options.extern_percent = 10;
+    options.entry_percent = 10;
+    options.label_percent = -1;
+    options.seed = 1;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc || argv[i][0] != '-' || argv[i][1] == '\0' || argv[i][2] != '\0')
+        {
+            parse_count("", argv[0]);
+        }
+        switch (argv[i][1])
+        {
+            case 'n': options.instructions = parse_count(argv[++i], argv[0]); break;
+            case 'l': options.labels = parse_count(argv[++i], argv[0]); break;
+            case 'k': options.macros = parse_count(argv[++i], argv[0]); break;
+            case 'd': options.directives = parse_count(argv[++i], argv[0]); break;
+            case 'x': options.extern_percent = parse_count(argv[++i], argv[0]); break;
+            case 'e': options.entry_percent = parse_count(argv[++i], argv[0]); break;
+            case 'p': options.label_percent = parse_count(argv[++i], argv[0]); break;
+            case 'r': options.seed = (unsigned long)parse_count(argv[++i], argv[0]); break;
+            default: parse_count("", argv[0]); break;
+        }
+    }
+    random_state = options.seed;
+
+    /* The macros are defined first, so every call comes after its definition */
+    for (i = 0; i < options.macros; i++)
+    {
+        printf("macr m%ld\n", i);
+        for (j = 0; j < MACRO_BODY_LINES; j++)
+        {
+            printf("    ");
+            write_instruction(&options);
+            printf("\n");
+        }
+        printf("endmacr\n");
+    }
+
+    /* The external symbols and the entry points */
+    if (options.extern_percent > 0 || options.labels == 0)
+    {
+        for (i = 0; i < EXTERN_SYMBOLS; i++)
+        {
+            printf(".extern X%ld\n", i);
+        }
+    }
+    for (i = 0; i < options.labels; i++)
+    {
+        if (random_below(100) < options.entry_percent)
+        {
+            printf(".entry L%ld\n", i);
+        }
+    }
+
+    /* The instructions with the directives mixed between them and the labels spread over both */
+    directive_count = options.instructions * options.directives / 100;
+    statements = options.instructions + directive_count;
+    label_every = options.labels > 0 && statements >= options.labels ? statements / options.labels : 1;
+    for (statement = 0; statement < statements || label < options.labels; statement++)
+    {
+        labeled = label < options.labels && statement % label_every == 0;
+        if (labeled)
+        {
+            printf("L%ld: ", label++);
+        }
+
+        /* Keep the directives spread evenly over the instructions */
+        if (directive < directive_count &&
+            (instruction >= options.instructions || directive * statements <= statement * directive_count))
+        {
+            write_directive(directive++);
+        }
+        else if (instruction < options.instructions && options.macros > 0 && instruction % MACRO_CALL_EVERY == MACRO_CALL_EVERY - 1)
+        {
+            /* A label cannot be put on a macro call */
+            if (labeled)
+            {
+                write_instruction(&options);
+            }
+            else
+            {
+                printf("m%ld", random_below(options.macros));
+            }
+            instruction++;
+        }
+        else
+        {
+            write_instruction(&options);
+            instruction++;
+        }
+        printf("\n");
+    }
+
+    return EXIT_SUCCESS;
+}
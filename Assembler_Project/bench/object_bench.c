@@ -0,0 +1,142 @@
+/*
+ * Benchmark of writing the object file.
+ * A code and data image of random 15-bit words is written to /dev/null a number of times in two ways:
+ * - fprintf: one fprintf("%04d %05o\n") per word, as the object file used to be written;
+ * - write_object_file: the lines formatted from the digit tables on the stack and written in chunks of lines.
+ * Both ways are first written to memory and compared, so the benchmark fails if their text differs.
+ * Prints the best time per word of every way.
+ *
+ * Usage: object_bench [-r runs] [-w words]
+ */
+#define _POSIX_C_SOURCE 200809L /* clock_gettime, open_memstream */
+
+#include <time.h>
+
+#include "../general_functions.h"
+#include "../object_file.h"
+
+#define DEFAULT_RUNS 200   /* Default number of writes of the image in every way, the best time is kept */
+#define DEFAULT_WORDS 4000 /* Default number of words of the image, about a full memory of 4096 words */
+
+/* Returns the time of a monotonic clock in seconds */
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/* Writes an object file with one fprintf per word, like the writer before the digit tables */
+static void write_object_fprintf(FILE *file, const uint16_t *code, size_t code_count, const uint16_t *data, size_t data_count)
+{
+    size_t i;
+
+    fprintf(file, "   %d  %d\n", (int)code_count, (int)data_count);
+    for (i = 0; i < code_count; i++)
+    {
+        fprintf(file, "%04d %05o\n", OBJECT_CODE_START + (int)i, code[i]);
+    }
+    for (i = 0; i < data_count; i++)
+    {
+        fprintf(file, "%04d %05o\n", OBJECT_CODE_START + (int)(code_count + i), data[i]);
+    }
+}
+
+/* Checks that both ways write the same text */
+static Bool same_output(const uint16_t *code, size_t code_count, const uint16_t *data, size_t data_count)
+{
+    char *first = NULL;
+    char *second = NULL;
+    size_t first_length = 0;
+    size_t second_length = 0;
+    FILE *stream;
+    Bool same;
+
+    stream = open_memstream(&first, &first_length);
+    write_object_fprintf(stream, code, code_count, data, data_count);
+    fclose(stream);
+    stream = open_memstream(&second, &second_length);
+    write_object_file(stream, code, code_count, data, data_count);
+    fclose(stream);
+
+    same = first_length == second_length && memcmp(first, second, first_length) == 0 ? TRUE : FALSE;
+    free(first);
+    free(second);
+    return same;
+}
+
+int main(int argc, char *argv[])
+{
+    uint16_t *words;
+    FILE *discard;
+    long runs = DEFAULT_RUNS;
+    long count = DEFAULT_WORDS;
+    size_t code_count;
+    double best_fprintf = 0;
+    double best_tables = 0;
+    double start;
+    double elapsed;
+    long run;
+    long i;
+
+    for (i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "-r") == 0)
+        {
+            runs = atol(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "-w") == 0)
+        {
+            count = atol(argv[i + 1]);
+        }
+    }
+    if (i != argc || runs < 1 || count < 1)
+    {
+        fprintf(stderr, "Usage: %s [-r runs] [-w words]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    words = (uint16_t *)malloc(count * sizeof(uint16_t));
+    discard = fopen("/dev/null", "w");
+    if (words == NULL || discard == NULL)
+    {
+        fprintf(stderr, "Unable to set up the benchmark\n");
+        return EXIT_FAILURE;
+    }
+    srand(1);
+    for (i = 0; i < count; i++)
+    {
+        words[i] = (uint16_t)(rand() & 0x7FFF);
+    }
+
+    /* Three quarters of the image are code, the rest is data */
+    code_count = (size_t)(count * 3 / 4);
+    if (!same_output(words, code_count, words + code_count, count - code_count))
+    {
+        fprintf(stderr, "Error: the two ways write different object files\n");
+        return EXIT_FAILURE;
+    }
+
+    for (run = 0; run < runs; run++)
+    {
+        start = now();
+        write_object_fprintf(discard, words, code_count, words + code_count, count - code_count);
+        fflush(discard);
+        elapsed = now() - start;
+        if (run == 0 || elapsed < best_fprintf) best_fprintf = elapsed;
+
+        start = now();
+        write_object_file(discard, words, code_count, words + code_count, count - code_count);
+        fflush(discard);
+        elapsed = now() - start;
+        if (run == 0 || elapsed < best_tables) best_tables = elapsed;
+    }
+
+    printf("%-20s %12s %12s\n", "object writer", "words", "ns/word");
+    printf("%-20s %12ld %12.1f\n", "fprintf", count, best_fprintf / count * 1e9);
+    printf("%-20s %12ld %12.1f\n", "write_object_file", count, best_tables / count * 1e9);
+
+    fclose(discard);
+    free(words);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,209 @@
+/*
+ * Benchmark of the assembler server against starting the assembler for every file.
+ * Every given source file is assembled a number of times in three ways, timing each one:
+ * - spawn: fork and exec of `assembler file`, as a build system runs it;
+ * - client: fork and exec of `assembler --connect socket file`, the thin client of a running server;
+ * - request: one request on a connection kept open to the server, with the source already in memory.
+ * The server is started with `assembler --serve` on a socket in /tmp and stopped at the end.
+ * Prints the mean, median and 99th percentile latency of every way in microseconds.
+ *
+ * Usage: serve_bench [-r runs] assembler file...  (the file names are given without the .as extension)
+ */
+#define _POSIX_C_SOURCE 200809L /* clock_gettime, kill */
+
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "../server.h"
+#include "../source_file.h"
+#include "../pre_assembler.h"
+
+#define DEFAULT_RUNS 200         /* Default number of runs of every file in every way */
+#define SERVER_WAIT_TRIES 200    /* Number of times to try to connect to the server while it starts */
+#define SOCKET_PATH_LENGTH 64    /* Room for the path of the socket */
+#define SERVER_WAIT_NS 10000000L /* Time between two tries, 10 ms */
+
+/* Returns the time of a monotonic clock in seconds */
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/* Runs a program with its output discarded and waits for it. Returns its pid, or -1 if it cannot be started */
+static pid_t start_program(char *const argv[], Bool wait_for_it)
+{
+    int status;
+    pid_t pid = fork();
+
+    if (pid == 0)
+    {
+        freopen("/dev/null", "w", stdout);
+        freopen("/dev/null", "w", stderr);
+        execv(argv[0], argv);
+        _exit(127);
+    }
+    if (pid > 0 && wait_for_it)
+    {
+        waitpid(pid, &status, 0);
+    }
+    return pid;
+}
+
+/* Orders latencies for qsort */
+static int compare_latencies(const void *a, const void *b)
+{
+    double first = *(const double *)a;
+    double second = *(const double *)b;
+
+    return first < second ? -1 : first > second ? 1 : 0;
+}
+
+/* Prints the mean, median and 99th percentile of the latencies of a way, which are sorted by the call */
+static void report(const char *file, const char *way, double *latencies, long runs)
+{
+    double total = 0;
+    long i;
+
+    qsort(latencies, runs, sizeof(double), compare_latencies);
+    for (i = 0; i < runs; i++)
+    {
+        total += latencies[i];
+    }
+    printf("%-28s %-8s %12.1f %12.1f %12.1f\n", file, way, total / runs * 1e6, latencies[runs / 2] * 1e6,
+           latencies[(runs * 99) / 100 < runs ? (runs * 99) / 100 : runs - 1] * 1e6);
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    char socket_path[SOCKET_PATH_LENGTH];
+    char *spawn_argv[3];
+    char *client_argv[5];
+    char *server_argv[4];
+    char *input_file_name;
+    struct timespec pause;
+    double *latencies;
+    double start;
+    SourceFile input;
+    asm_result result;
+    long runs = DEFAULT_RUNS;
+    long run;
+    pid_t server;
+    int status;
+    int first = 1;
+    int fd = -1;
+    int i;
+
+    if (argc > 2 && strcmp(argv[1], "-r") == 0)
+    {
+        runs = atol(argv[2]);
+        first = 3;
+    }
+    if (first + 1 >= argc || runs < 1)
+    {
+        fprintf(stderr, "Usage: %s [-r runs] assembler file...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    latencies = (double *)malloc(runs * sizeof(double));
+    if (latencies == NULL)
+    {
+        fprintf(stderr, "Unable to allocate memory for the latencies\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Start the server and wait until it accepts connections */
+    sprintf(socket_path, "/tmp/serve_bench.%ld.sock", (long)getpid());
+    server_argv[0] = argv[first];
+    server_argv[1] = "--serve";
+    server_argv[2] = socket_path;
+    server_argv[3] = NULL;
+    server = start_program(server_argv, FALSE);
+    for (i = 0; server > 0 && fd < 0 && i < SERVER_WAIT_TRIES; i++)
+    {
+        pause.tv_sec = 0;
+        pause.tv_nsec = SERVER_WAIT_NS;
+        nanosleep(&pause, NULL);
+        fd = connect_server(socket_path);
+    }
+    if (fd < 0)
+    {
+        fprintf(stderr, "Error: the server did not start on %s\n", socket_path);
+        if (server > 0)
+        {
+            kill(server, SIGTERM);
+        }
+        free(latencies);
+        return EXIT_FAILURE;
+    }
+
+    printf("%-28s %-8s %12s %12s %12s\n", "file", "way", "mean us", "p50 us", "p99 us");
+    fflush(stdout);
+    for (i = first + 1; i < argc; i++)
+    {
+        spawn_argv[0] = argv[first];
+        spawn_argv[1] = argv[i];
+        spawn_argv[2] = NULL;
+        for (run = 0; run < runs; run++)
+        {
+            start = now();
+            start_program(spawn_argv, TRUE);
+            latencies[run] = now() - start;
+        }
+        report(argv[i], "spawn", latencies, runs);
+
+        client_argv[0] = argv[first];
+        client_argv[1] = "--connect";
+        client_argv[2] = socket_path;
+        client_argv[3] = argv[i];
+        client_argv[4] = NULL;
+        for (run = 0; run < runs; run++)
+        {
+            start = now();
+            start_program(client_argv, TRUE);
+            latencies[run] = now() - start;
+        }
+        report(argv[i], "client", latencies, runs);
+
+        input_file_name = (char *)malloc(strlen(argv[i]) + END_OF_FILE + 1);
+        if (input_file_name == NULL)
+        {
+            break;
+        }
+        my_snprintf(input_file_name, strlen(argv[i]) + END_OF_FILE + 1, "%s%s", argv[i], ".as");
+        if (!open_source_file(&input, input_file_name))
+        {
+            fprintf(stderr, "Error opening input file: %s\n", input_file_name);
+            free(input_file_name);
+            break;
+        }
+        free(input_file_name);
+        for (run = 0; run < runs; run++)
+        {
+            start = now();
+            if (!request_assembly(fd, argv[i], input.data, input.size, 0, &result, &status))
+            {
+                fprintf(stderr, "Error: the server closed the connection\n");
+                break;
+            }
+            latencies[run] = now() - start;
+            asm_result_free(&result);
+        }
+        close_source_file(&input);
+        if (run < runs)
+        {
+            break;
+        }
+        report(argv[i], "request", latencies, runs);
+    }
+
+    close(fd);
+    kill(server, SIGTERM);
+    waitpid(server, NULL, 0);
+    free(latencies);
+    return i < argc ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,193 @@
+/*
+ * Benchmark of the stages of the assembler.
+ * Every given source file is assembled a few times the way process_file does it, timing each stage:
+ * - macro_file: opening the source and expanding the macros;
+ * - firstPass: parsing the expanded source into the symbol table and the code and data images;
+ * - secondPass: resolving the labels and writing the .ob, .ent and .ext files.
+ * Prints the best time of every stage, the lines of source per second over the three stages,
+ * and the peak resident set size of the process at the end.
+ * The errors of a file are printed on its first run only. The macro definition cache is
+ * emptied before every run, so each run parses its macros like the first file of a run would.
+ *
+ * Usage: stage_bench [-r runs] file...  (the file names are given without the .as extension)
+ */
+#define _POSIX_C_SOURCE 199309L /* clock_gettime */
+
+#include <time.h>
+#include <sys/resource.h>
+
+#include "../general_functions.h"
+#include "../pre_assembler.h"
+#include "../first_pass.h"
+#include "../second_pass.h"
+
+#define DEFAULT_RUNS 5 /* Default number of runs of every file, the best time of each stage is kept */
+
+/*
+ * Structure to represent the times of the stages of one run, in seconds.
+ */
+typedef struct {
+    double macro_file;
+    double first_pass;
+    double second_pass;
+} StageTimes;
+
+/* Returns the time of a monotonic clock in seconds */
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/* Counts the lines of a source */
+static long count_lines(const char *text, size_t length)
+{
+    const char *end = text + length;
+    const char *newline;
+    long lines = 0;
+
+    while (text < end)
+    {
+        lines++;
+        newline = memchr(text, '\n', end - text);
+        if (newline == NULL)
+        {
+            break;
+        }
+        text = newline + 1;
+    }
+    return lines;
+}
+
+/*
+ * Assembles a file once, the same way as process_file without the output cache, and times its stages.
+ * Returns FALSE if the source file cannot be opened.
+ */
+static Bool run_stages(char *file_name, StageTimes *times, long *lines)
+{
+    Bool no_errors = TRUE;
+    int IC = 100;
+    SymbolTable labels;
+    ExternList externList;
+    InstructionArray instructionArray;
+    Program program;
+    EntryList *entryList;
+    DataSegment dataSegment;
+    ExpandedSource source;
+    SourceFile input;
+    char *input_file_name;
+    Arena arena;
+    double start;
+
+    start = now();
+    arena_init(&arena);
+    input_file_name = (char *)arena_alloc(&arena, strlen(file_name) + END_OF_FILE + 1);
+    my_snprintf(input_file_name, strlen(file_name) + END_OF_FILE + 1, "%s%s", file_name, ".as");
+    if (!open_source_file(&input, input_file_name))
+    {
+        fprintf(stderr, "Error opening input file: %s\n", input_file_name);
+        arena_free(&arena);
+        return FALSE;
+    }
+    entryList = (EntryList *)arena_alloc(&arena, sizeof(EntryList));
+    initSymbolTable(&labels, &arena);
+    initEntryList(entryList, &arena);
+    initExternList(&externList, &arena);
+    init_instruction_array(&instructionArray, 2, &arena);
+    init_program(&program, &labels, &arena);
+    initDataSegment(&dataSegment, &arena);
+    init_expanded_source(&source, &arena);
+
+    times->first_pass = 0;
+    times->second_pass = 0;
+    if (macro_file(file_name, &input, &arena, &source, FALSE))
+    {
+        times->macro_file = now() - start;
+
+        start = now();
+        no_errors = firstPass(&source, file_name, &IC, &labels, &externList, entryList, &dataSegment, &program);
+        times->first_pass = now() - start;
+
+        start = now();
+        secondPass(file_name, &IC, &labels, &externList, &entryList, &dataSegment, &instructionArray, &program, &no_errors);
+        times->second_pass = now() - start;
+    }
+    else
+    {
+        times->macro_file = now() - start;
+        fprintf(errorStream(), "Failed to process file: %s\n", file_name);
+    }
+
+    *lines = count_lines(input.data, input.size);
+    close_source_file(&input);
+    arena_free(&arena);
+    return TRUE;
+}
+
+/* Keeps the shorter time of every stage */
+static void keep_best(StageTimes *best, const StageTimes *times, int first)
+{
+    if (first || times->macro_file < best->macro_file) best->macro_file = times->macro_file;
+    if (first || times->first_pass < best->first_pass) best->first_pass = times->first_pass;
+    if (first || times->second_pass < best->second_pass) best->second_pass = times->second_pass;
+}
+
+int main(int argc, char *argv[])
+{
+    StageTimes best;
+    StageTimes times;
+    struct rusage usage;
+    FILE *discard;
+    long runs = DEFAULT_RUNS;
+    long lines = 0;
+    double total;
+    int first = 1;
+    int run;
+    int i;
+
+    if (argc > 2 && strcmp(argv[1], "-r") == 0)
+    {
+        runs = atol(argv[2]);
+        first = 3;
+    }
+    if (first >= argc || runs < 1)
+    {
+        fprintf(stderr, "Usage: %s [-r runs] file...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    discard = fopen("/dev/null", "w");
+
+    printf("%-28s %9s %12s %12s %12s %12s %12s\n", "file", "lines", "macro_file", "firstPass", "secondPass", "total", "lines/s");
+    fflush(stdout);
+    for (i = first; i < argc; i++)
+    {
+        for (run = 0; run < runs; run++)
+        {
+            /* Report the errors of the file once */
+            setErrorStream(run == 0 ? NULL : discard);
+            free_definition_cache();
+            if (!run_stages(argv[i], &times, &lines))
+            {
+                return EXIT_FAILURE;
+            }
+            keep_best(&best, &times, run == 0);
+        }
+        setErrorStream(NULL);
+
+        total = best.macro_file + best.first_pass + best.second_pass;
+        printf("%-28s %9ld %9.3f ms %9.3f ms %9.3f ms %9.3f ms %12.0f\n", argv[i], lines, best.macro_file * 1e3,
+               best.first_pass * 1e3, best.second_pass * 1e3, total * 1e3, total > 0 ? lines / total : 0.0);
+        fflush(stdout);
+    }
+
+    getrusage(RUSAGE_SELF, &usage);
+    printf("peak RSS: %ld KB\n", usage.ru_maxrss);
+
+    if (discard != NULL)
+    {
+        fclose(discard);
+    }
+    free_definition_cache();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,245 @@
+#include "binary_object.h"
+
+/* Rounds a size up to the alignment of the tables */
+static size_t align_table(size_t size)
+{
+    return (size + ASM_OBJECT_ALIGNMENT - 1) / ASM_OBJECT_ALIGNMENT * ASM_OBJECT_ALIGNMENT;
+}
+
+/*
+ * Structure to represent the tables of a file while they are built.
+ * - externs: The uses of extern labels, or NULL to only count them.
+ * - relocations: The addresses of the relocatable words, or NULL to only count them.
+ * - extern_count: The number of uses of extern labels.
+ * - relocation_count: The number of relocatable words.
+ * - strings: The names, or NULL to only count the room they need.
+ * - strings_size: The number of bytes of the names.
+ * - name_offsets: The offset of the name of every symbol of the program in the strings, -1 before
+ *   it is added, so an extern label used many times is stored once.
+ */
+typedef struct {
+    asm_object_symbol *externs;
+    asm_u32 *relocations;
+    asm_u32 extern_count;
+    asm_u32 relocation_count;
+    char *strings;
+    asm_u32 strings_size;
+    long *name_offsets;
+} ObjectTables;
+
+/* Adds a name to the strings and returns its offset */
+static asm_u32 add_name(ObjectTables *tables, const char *name)
+{
+    asm_u32 offset = tables->strings_size;
+    size_t length = strlen(name) + 1;
+
+    if (tables->strings != NULL)
+    {
+        memcpy(tables->strings + offset, name, length);
+    }
+    tables->strings_size += (asm_u32)length;
+    return offset;
+}
+
+/*
+ * Adds the word of a label operand to the tables: an external word is a use of its extern label,
+ * a relocatable word holds the address of a label of the file.
+ */
+static void add_label_word(ObjectTables *tables, const InstructionArray *instructionArray, const Program *program,
+                           int symbol, int address)
+{
+    size_t index = (size_t)(address - OBJECT_CODE_START);
+    int are;
+
+    if (address < OBJECT_CODE_START || index >= instructionArray->size)
+    {
+        return;
+    }
+    are = instructionArray->words[index] & ARE_MASK;
+    if (are == ARE_EXTERNAL)
+    {
+        if (tables->externs != NULL)
+        {
+            if (tables->name_offsets[symbol] < 0)
+            {
+                tables->name_offsets[symbol] = (long)add_name(tables, program->symbols->labels[symbol].name);
+            }
+            tables->externs[tables->extern_count].name = (asm_u32)tables->name_offsets[symbol];
+            tables->externs[tables->extern_count].address = (asm_u32)address;
+        }
+        else
+        {
+            /* Room for the name at every use, more than is needed */
+            tables->strings_size += (asm_u32)strlen(program->symbols->labels[symbol].name) + 1;
+        }
+        tables->extern_count++;
+    }
+    else if (are == ARE_RELOCATABLE)
+    {
+        if (tables->relocations != NULL)
+        {
+            tables->relocations[tables->relocation_count] = (asm_u32)address;
+        }
+        tables->relocation_count++;
+    }
+}
+
+/*
+ * Walks the label operands of the instructions in the order the second pass encodes them.
+ * The word of a label operand follows the first word of its instruction, after the word of
+ * the source operand when it is the destination.
+ */
+static void add_label_words(ObjectTables *tables, const InstructionArray *instructionArray, const Program *program)
+{
+    const Statement *statement;
+    size_t i;
+
+    for (i = 0; i < program->size; i++)
+    {
+        statement = &program->statements[i];
+        if (statement->kind != STATEMENT_INSTRUCTION)
+        {
+            continue;
+        }
+        if (statement->source_mode == METHOD_DIRECT_ADDRESSING)
+        {
+            add_label_word(tables, instructionArray, program, statement->source_value, statement->address + 1);
+        }
+        if (statement->dest_mode == METHOD_DIRECT_ADDRESSING)
+        {
+            add_label_word(tables, instructionArray, program, statement->dest_value,
+                           statement->address + (statement->source_mode != NO_OPERAND ? 2 : 1));
+        }
+    }
+}
+
+/*
+ * Counts the tables, then builds the header and every table in one zeroed buffer and writes it.
+ */
+Bool write_binary_object(FILE *file, SymbolTable *labels, const EntryList *entryList, const DataSegment *dataSegment,
+                         const InstructionArray *instructionArray, const Program *program)
+{
+    ObjectTables tables;
+    asm_object_header header;
+    asm_object_symbol *entries;
+    size_t strings_room;
+    size_t size;
+    char *buffer;
+    Bool written;
+    int i;
+
+    /* Count the records and the room of the names */
+    memset(&tables, 0, sizeof(tables));
+    add_label_words(&tables, instructionArray, program);
+    for (i = 0; i < entryList->size; i++)
+    {
+        add_name(&tables, entryList->entries[i].labelName);
+    }
+    strings_room = tables.strings_size;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ASM_OBJECT_MAGIC, sizeof(header.magic));
+    header.byte_order = ASM_OBJECT_BYTE_ORDER;
+    header.version = ASM_OBJECT_VERSION;
+    header.header_size = sizeof(asm_object_header);
+    header.base_address = OBJECT_CODE_START;
+    header.code_words = (asm_u32)instructionArray->size;
+    header.data_words = (asm_u32)dataSegment->size;
+    header.entry_count = (asm_u32)entryList->size;
+    header.extern_count = tables.extern_count;
+    header.relocation_count = tables.relocation_count;
+    header.words_offset = (asm_u32)align_table(sizeof(asm_object_header));
+    header.entries_offset = (asm_u32)align_table(header.words_offset + (header.code_words + header.data_words) * sizeof(asm_u16));
+    header.externs_offset = header.entries_offset + header.entry_count * sizeof(asm_object_symbol);
+    header.relocations_offset = header.externs_offset + header.extern_count * sizeof(asm_object_symbol);
+    header.strings_offset = header.relocations_offset + header.relocation_count * sizeof(asm_u32);
+
+    buffer = (char *)calloc(1, header.strings_offset + strings_room);
+    tables.name_offsets = (long *)malloc((program->symbols->count + 1) * sizeof(long));
+    if (buffer == NULL || tables.name_offsets == NULL)
+    {
+        fprintf(errorStream(), "Unable to allocate memory for the object file\n");
+        free(buffer);
+        free(tables.name_offsets);
+        return FALSE;
+    }
+
+    /* Fill the tables in place: the entries first, then the words of the label operands */
+    memcpy(buffer + header.words_offset, instructionArray->words, header.code_words * sizeof(asm_u16));
+    memcpy(buffer + header.words_offset + header.code_words * sizeof(asm_u16), dataSegment->words, header.data_words * sizeof(asm_u16));
+    tables.externs = (asm_object_symbol *)(buffer + header.externs_offset);
+    tables.relocations = (asm_u32 *)(buffer + header.relocations_offset);
+    tables.strings = buffer + header.strings_offset;
+    tables.strings_size = 0;
+    tables.extern_count = 0;
+    tables.relocation_count = 0;
+    for (i = 0; i < program->symbols->count; i++)
+    {
+        tables.name_offsets[i] = -1;
+    }
+    entries = (asm_object_symbol *)(buffer + header.entries_offset);
+    for (i = 0; i < entryList->size; i++)
+    {
+        entries[i].name = add_name(&tables, entryList->entries[i].labelName);
+        entries[i].address = (asm_u32)check_label_name(labels, entryList->entries[i].labelName);
+    }
+    add_label_words(&tables, instructionArray, program);
+
+    /* The names of an extern label used many times were counted at every use */
+    header.strings_size = tables.strings_size;
+    header.file_size = header.strings_offset + header.strings_size;
+    memcpy(buffer, &header, sizeof(header));
+
+    size = header.file_size;
+    written = fwrite(buffer, 1, size, file) == size ? TRUE : FALSE;
+    free(tables.name_offsets);
+    free(buffer);
+    return written;
+}
+
+/*
+ * Writes the .obj file of a file without errors, or removes a stale one.
+ */
+Bool write_binary_object_file(const char *file_name, Bool no_errors, SymbolTable *labels, const EntryList *entryList,
+                              const DataSegment *dataSegment, const InstructionArray *instructionArray, const Program *program)
+{
+    size_t length = strlen(file_name) + strlen(BINARY_OBJECT_EXTENSION) + 1;
+    char *obj_filename = (char *)malloc(length);
+    FILE *file_obj;
+    Bool written;
+
+    if (obj_filename == NULL)
+    {
+        fprintf(errorStream(), "Unable to allocate memory for file names\n");
+        return FALSE;
+    }
+    my_snprintf(obj_filename, length, "%s%s", file_name, BINARY_OBJECT_EXTENSION);
+    if (!no_errors)
+    {
+        remove(obj_filename);
+        free(obj_filename);
+        return TRUE;
+    }
+
+    file_obj = fopen(obj_filename, "wb");
+    if (file_obj == NULL)
+    {
+        fprintf(errorStream(), "Error opening .obj file: %s\n", obj_filename);
+        free(obj_filename);
+        return FALSE;
+    }
+    written = write_binary_object(file_obj, labels, entryList, dataSegment, instructionArray, program);
+
+    /* The end of the object may only reach the file when it is closed */
+    if (fclose(file_obj) != 0)
+    {
+        written = FALSE;
+    }
+    if (!written)
+    {
+        fprintf(errorStream(), "Error writing .obj file: %s\n", obj_filename);
+        remove(obj_filename);
+    }
+    free(obj_filename);
+    return written;
+}
@@ -0,0 +1,48 @@
+#ifndef BINARY_OBJECT_H
+#define BINARY_OBJECT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "general_functions.h"
+#include "second_pass.h"
+#include "asm_object.h"
+
+#define BINARY_OBJECT_EXTENSION ".obj" /* Extension of the packed binary object file */
+
+/*
+ * Writes the outputs of a file in the packed binary object format of asm_object.h: the code and
+ * data images, the entries, the uses of extern labels and the relocatable words.
+ * The tables are built from the statements of the program and the encoded words, so they hold
+ * the same entries and externs as the .ent and .ext files.
+ * The whole file is built in one buffer and written with a single fwrite.
+ *
+ * @param file: The stream of the .obj file.
+ * @param labels: The symbol table, with the addresses of the second pass.
+ * @param entryList: The entries of the file.
+ * @param dataSegment: The data image.
+ * @param instructionArray: The code image.
+ * @param program: The statements of the file.
+ * @return: TRUE if the whole file was written, FALSE otherwise.
+ */
+Bool write_binary_object(FILE *file, SymbolTable *labels, const EntryList *entryList, const DataSegment *dataSegment,
+                         const InstructionArray *instructionArray, const Program *program);
+
+/*
+ * Writes <file_name>.obj for a file that assembled without errors, and removes it otherwise,
+ * the same way as the second pass writes and removes the .ob file.
+ *
+ * @param file_name: The base name of the file.
+ * @param no_errors: TRUE if the file assembled without errors and fits in memory.
+ * @param labels: The symbol table, with the addresses of the second pass.
+ * @param entryList: The entries of the file.
+ * @param dataSegment: The data image.
+ * @param instructionArray: The code image.
+ * @param program: The statements of the file.
+ * @return: FALSE if the .obj file could not be written, which is reported; TRUE otherwise.
+ */
+Bool write_binary_object_file(const char *file_name, Bool no_errors, SymbolTable *labels, const EntryList *entryList,
+                              const DataSegment *dataSegment, const InstructionArray *instructionArray, const Program *program);
+
+#endif /* BINARY_OBJECT_H */
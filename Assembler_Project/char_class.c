@@ -0,0 +1,276 @@
+#include <pthread.h>
+
+#include "char_class.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define HAVE_SSE2 1
+#include <emmintrin.h>
+#if __GNUC__ >= 5
+#define HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+#define SHORT_SPAN 32 /* Number of characters scanned through the table before switching to the implementation in use */
+
+#define S CHAR_SPACE
+#define N CHAR_NEWLINE
+#define C CHAR_COMMA
+#define Q CHAR_QUOTE
+
+/* Table of the classes of every character, the characters that are not listed have no class */
+const unsigned char char_class_table[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, S, N, S, S, S, 0, 0,   /* 0x00 - 0x0F: \t \n \v \f \r */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   /* 0x10 - 0x1F */
+    S, 0, Q, 0, 0, 0, 0, 0, 0, 0, 0, 0, C             /* 0x20 - 0x2C: space " , */
+};
+
+#undef S
+#undef N
+#undef C
+#undef Q
+
+/* Signature of an implementation: finds the first character whose membership in the classes equals in_class */
+typedef const char *(*FindFunction)(const char *text, const char *end, unsigned int classes, Bool in_class);
+
+static FindFunction find_function;                     /* The implementation in use */
+static CharClassImpl find_impl;                         /* Which implementation is in use */
+static pthread_once_t find_once = PTHREAD_ONCE_INIT;    /* Selects the default implementation once */
+
+/* Scalar implementation: one character at a time through the table */
+static const char *find_scalar(const char *text, const char *end, unsigned int classes, Bool in_class)
+{
+    while (text < end && (IS_CHAR_CLASS(*text, classes) != 0) != in_class)
+    {
+        text++;
+    }
+    return text;
+}
+
+#ifdef HAVE_SSE2
+/* Returns a mask with one bit for every character of a 16-character chunk that belongs to the classes */
+static unsigned int class_mask_sse2(__m128i chunk, unsigned int classes)
+{
+    __m128i hits = _mm_setzero_si128();
+    __m128i newline = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'));
+
+    if (classes & CHAR_SPACE)
+    {
+        /* The characters 9 to 13 are \t \n \v \f \r: subtract 9 and compare unsigned with 4 */
+        __m128i offset = _mm_sub_epi8(chunk, _mm_set1_epi8(9));
+        __m128i in_range = _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(4)), offset);
+        hits = _mm_or_si128(hits, _mm_andnot_si128(newline, in_range));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')));
+    }
+    if (classes & CHAR_NEWLINE)
+    {
+        hits = _mm_or_si128(hits, newline);
+    }
+    if (classes & CHAR_COMMA)
+    {
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(',')));
+    }
+    if (classes & CHAR_QUOTE)
+    {
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')));
+    }
+    return (unsigned int)_mm_movemask_epi8(hits);
+}
+
+/* SSE2 implementation: 16 characters at a time, the remainder through the table */
+static const char *find_sse2(const char *text, const char *end, unsigned int classes, Bool in_class)
+{
+    unsigned int mask;
+
+    while (end - text >= 16)
+    {
+        mask = class_mask_sse2(_mm_loadu_si128((const __m128i *)text), classes);
+        if (!in_class)
+        {
+            mask = ~mask & 0xFFFF;
+        }
+        if (mask != 0)
+        {
+            return text + __builtin_ctz(mask);
+        }
+        text += 16;
+    }
+    return find_scalar(text, end, classes, in_class);
+}
+
+#endif
+
+#ifdef HAVE_AVX2
+/* Returns a mask with one bit for every character of a 32-character chunk that belongs to the classes */
+__attribute__((target("avx2")))
+static unsigned int class_mask_avx2(__m256i chunk, unsigned int classes)
+{
+    __m256i hits = _mm256_setzero_si256();
+    __m256i newline = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n'));
+
+    if (classes & CHAR_SPACE)
+    {
+        /* The characters 9 to 13 are \t \n \v \f \r: subtract 9 and compare unsigned with 4 */
+        __m256i offset = _mm256_sub_epi8(chunk, _mm256_set1_epi8(9));
+        __m256i in_range = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(4)), offset);
+        hits = _mm256_or_si256(hits, _mm256_andnot_si256(newline, in_range));
+        hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')));
+    }
+    if (classes & CHAR_NEWLINE)
+    {
+        hits = _mm256_or_si256(hits, newline);
+    }
+    if (classes & CHAR_COMMA)
+    {
+        hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(',')));
+    }
+    if (classes & CHAR_QUOTE)
+    {
+        hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"')));
+    }
+    return (unsigned int)_mm256_movemask_epi8(hits);
+}
+
+/* AVX2 implementation: 32 characters at a time, the remainder through SSE2 */
+__attribute__((target("avx2")))
+static const char *find_avx2(const char *text, const char *end, unsigned int classes, Bool in_class)
+{
+    unsigned int mask;
+
+    while (end - text >= 32)
+    {
+        mask = class_mask_avx2(_mm256_loadu_si256((const __m256i *)text), classes);
+        if (!in_class)
+        {
+            mask = ~mask;
+        }
+        if (mask != 0)
+        {
+            return text + __builtin_ctz(mask);
+        }
+        text += 32;
+    }
+    return find_sse2(text, end, classes, in_class);
+}
+
+#endif
+
+/* Selects the widest implementation the processor supports */
+static void select_default_impl(void)
+{
+    find_function = find_scalar;
+    find_impl = CHAR_CLASS_SCALAR;
+#ifdef HAVE_SSE2
+    find_function = find_sse2;
+    find_impl = CHAR_CLASS_SSE2;
+#endif
+#ifdef HAVE_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        find_function = find_avx2;
+        find_impl = CHAR_CLASS_AVX2;
+    }
+#endif
+}
+
+/* 
+ * Finds the first character of the range in the classes. Most spans in a source line are a
+ * few characters long, so the first characters go through the table, which costs less than
+ * setting up a vector; only longer spans reach the implementation in use.
+ */
+const char *scan_to_class(const char *text, const char *end, unsigned int classes)
+{
+    const char *short_end = end - text > SHORT_SPAN ? text + SHORT_SPAN : end;
+
+    while (text < short_end)
+    {
+        if (IS_CHAR_CLASS(*text, classes))
+        {
+            return text;
+        }
+        text++;
+    }
+    if (text == end)
+    {
+        return end;
+    }
+    pthread_once(&find_once, select_default_impl);
+    return find_function(text, end, classes, TRUE);
+}
+
+/* Finds the first character of the range that is not in the classes, like scan_to_class */
+const char *skip_class(const char *text, const char *end, unsigned int classes)
+{
+    const char *short_end = end - text > SHORT_SPAN ? text + SHORT_SPAN : end;
+
+    while (text < short_end)
+    {
+        if (!IS_CHAR_CLASS(*text, classes))
+        {
+            return text;
+        }
+        text++;
+    }
+    if (text == end)
+    {
+        return end;
+    }
+    pthread_once(&find_once, select_default_impl);
+    return find_function(text, end, classes, FALSE);
+}
+
+/* Walks back from the end of the range, trailing runs are short so the table is enough */
+const char *skip_class_backward(const char *text, const char *end, unsigned int classes)
+{
+    while (end > text && IS_CHAR_CLASS(*(end - 1), classes))
+    {
+        end--;
+    }
+    return end;
+}
+
+/* Replaces the implementation in use if the processor supports it */
+Bool use_char_class_impl(CharClassImpl impl)
+{
+    pthread_once(&find_once, select_default_impl);
+    switch (impl)
+    {
+        case CHAR_CLASS_SCALAR:
+            find_function = find_scalar;
+            break;
+#ifdef HAVE_SSE2
+        case CHAR_CLASS_SSE2:
+            find_function = find_sse2;
+            break;
+#endif
+#ifdef HAVE_AVX2
+        case CHAR_CLASS_AVX2:
+            if (!__builtin_cpu_supports("avx2"))
+            {
+                return FALSE;
+            }
+            find_function = find_avx2;
+            break;
+#endif
+        default:
+            return FALSE;
+    }
+    find_impl = impl;
+    return TRUE;
+}
+
+/* Returns the name of the implementation in use */
+const char *char_class_impl_name(void)
+{
+    pthread_once(&find_once, select_default_impl);
+    switch (find_impl)
+    {
+        case CHAR_CLASS_SSE2:
+            return "sse2";
+        case CHAR_CLASS_AVX2:
+            return "avx2";
+        default:
+            return "scalar";
+    }
+}
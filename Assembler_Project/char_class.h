@@ -0,0 +1,74 @@
+#ifndef CHAR_CLASS_H
+#define CHAR_CLASS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "general_functions.h"
+
+/* The character classes the scanner looks for, which can be combined with | */
+#define CHAR_SPACE 1      /* ' ', '\t', '\v', '\f' and '\r' */
+#define CHAR_NEWLINE 2    /* '\n' */
+#define CHAR_COMMA 4      /* ',' */
+#define CHAR_QUOTE 8      /* '"' */
+#define CHAR_WHITESPACE (CHAR_SPACE | CHAR_NEWLINE) /* The characters isspace accepts */
+
+/* The implementations of the scanner */
+typedef enum {
+    CHAR_CLASS_SCALAR, /* One character at a time through a lookup table */
+    CHAR_CLASS_SSE2,   /* 16 characters at a time */
+    CHAR_CLASS_AVX2    /* 32 characters at a time */
+} CharClassImpl;
+
+/* Table of the classes of every character */
+extern const unsigned char char_class_table[256];
+
+/* Checks whether a character belongs to one of the given classes */
+#define IS_CHAR_CLASS(c, classes) (char_class_table[(unsigned char)(c)] & (classes))
+
+/* 
+ * Finds the first character in a range that belongs to one of the given classes.
+ * 
+ * @param text: The start of the range.
+ * @param end: The end of the range (one past its last character).
+ * @param classes: The classes to look for.
+ * @return: Pointer to the first matching character, or end if there is none.
+ */
+const char *scan_to_class(const char *text, const char *end, unsigned int classes);
+
+/* 
+ * Skips the characters at the start of a range that belong to one of the given classes.
+ * 
+ * @param text: The start of the range.
+ * @param end: The end of the range (one past its last character).
+ * @param classes: The classes to skip.
+ * @return: Pointer to the first character that does not match, or end if there is none.
+ */
+const char *skip_class(const char *text, const char *end, unsigned int classes);
+
+/* 
+ * Skips the characters at the end of a range that belong to one of the given classes.
+ * 
+ * @param text: The start of the range.
+ * @param end: The end of the range (one past its last character).
+ * @param classes: The classes to skip.
+ * @return: The new end of the range, one past the last character that does not match.
+ */
+const char *skip_class_backward(const char *text, const char *end, unsigned int classes);
+
+/* 
+ * Selects the implementation of the scanner. By default the widest one the processor
+ * supports is selected the first time the scanner is used.
+ * 
+ * @param impl: The implementation to use.
+ * @return: TRUE if the implementation is supported and was selected, FALSE otherwise.
+ */
+Bool use_char_class_impl(CharClassImpl impl);
+
+/* 
+ * Returns the name of the implementation of the scanner that is in use.
+ */
+const char *char_class_impl_name(void);
+
+#endif /* CHAR_CLASS_H */
@@ -1,202 +1,89 @@
 #include "data.h"
+#include "char_class.h"
 
 #define MAX_NUMBER 16383 /* Maximum positive value for 15-bit signed integer */
 #define MIN_NUMBER -16384 /* Minimum negative value for 15-bit signed integer */
 
 /* 
-	Function: createData
-	Creates a new Data object, initializes it with the given number and line number,
-	and converts the number to its 15-bit binary representation.
+	Function: initDataSegment
+	Initializes an empty data segment with room for the initial number of words.
 
 	Parameters:
-		number - The integer value to store in the Data object.
-		lineNumber - The line number associated with this Data object.
-
-	Returns:
-		A pointer to the newly created Data object.
+		segment - A pointer to the data segment to initialize.
+		arena - The arena that owns the memory of the segment.
 */
-Data* createData(int number, int lineNumber)
+void initDataSegment(DataSegment* segment, Arena* arena)
 {
-	Data* newData = (Data*)malloc(sizeof(Data));
-	if (newData == NULL)
-	{
-		fprintf(stderr, "Unable to allocate memory for new Data\n");
-		exit(EXIT_FAILURE);
-	}
-
-	newData->number = number;
-	newData->lineNumber = lineNumber;
-    
-	/* Convert number to binary representation */
-	newData->numberValue = to_15bit_binary(number);
-
-	newData->next = NULL;
-
-	return newData;
+	segment->capacity = DATA_SEGMENT_INITIAL_CAPACITY;
+	segment->size = 0;
+	segment->arena = arena;
+	segment->words = (uint16_t*)arena_alloc(arena, segment->capacity * sizeof(uint16_t));
 }
 
 /* 
-	Function: addData
-	Adds a new Data object to the end of the list. 
+	Function: addDataWord
+	Appends a word to the end of the data segment, doubling its capacity when it is full.
 
 	Parameters:
-		head - A pointer to the pointer of the head of the Data list.
-		number - The integer value to store in the new Data object.
-		lineNumber - The line number associated with this Data object.
+		segment - A pointer to the data segment.
+		word - The 15-bit word to append.
 */
-void addData(Data** head, int number, int lineNumber)
+static void addDataWord(DataSegment* segment, uint16_t word)
 {
-	Data* current = *head;
-	Data* newData;
-	newData = createData(number, lineNumber); 
-	
-	if (*head == NULL) 
+	if (segment->size >= segment->capacity)
 	{
-		*head = newData;
-		return;
+		segment->words = (uint16_t*)arena_grow(segment->arena, segment->words,
+			segment->capacity * sizeof(uint16_t), segment->capacity * 2 * sizeof(uint16_t));
+		segment->capacity *= 2;
 	}
-
-	while (current->next != NULL) 
-	{
-		current = current->next;
-	}
-
-	current->next = newData;
+	segment->words[segment->size++] = word;
 }
 
 /* 
-	Function: freeDataList
-	Frees all memory allocated for the Data list.
-
-	Parameters:
-		head - A pointer to the head of the Data list.
-*/
-void freeDataList(Data* head)
-{
-	Data* current = head;
-	Data* nextNode;
-	while (current != NULL)
-	{
-		nextNode = current->next;
-		free(current);
-		current = nextNode;
-	}
-}
-
-/* 
-	Function: printDataList
-	Prints the entire Data list.
-
-	Parameters:
-		head - A pointer to the head of the Data list.
-*/
-void printDataList(Data* head)
-{
-	Data* current = head;
-	while (current != NULL)
-	{
-		printf("Number: %d\n", current->number);
-		printf("Line Number: %d\n", current->lineNumber);
-		printf("15-bit Binary Representation: ");
-		printBinary(current->numberValue, 15); /* Print as binary */
-		putchar('\n');
-		current = current->next;
-	}
-}
-
-/* 
-	Function: createCharData
-	Creates a new CharData object, initializes it with the given character and line number,
-	and computes the ASCII value of the character.
+	Function: addData
+	Converts a number to its 15-bit binary representation and appends it to the data segment.
 
 	Parameters:
-		character - The character to store in the CharData object.
-		lineNumber - The line number associated with this CharData object.
-
-	Returns:
-		A pointer to the newly created CharData object.
+		segment - A pointer to the data segment.
+		number - The integer value to append.
 */
-CharData* createCharData(char character, int lineNumber)
+void addData(DataSegment* segment, int number)
 {
-	CharData* newCharData = (CharData*)malloc(sizeof(CharData));
-	if (newCharData == NULL)
-	{
-		fprintf(stderr, "Unable to allocate memory for new CharData\n");
-		exit(EXIT_FAILURE);
-	}
-	newCharData->character = character;
-	newCharData->lineNumber = lineNumber;
-	newCharData->asciiValue = (unsigned char)character; 
-	newCharData->next = NULL;
-	return newCharData;
+	addDataWord(segment, to_15bit_binary(number));
 }
 
 /* 
 	Function: addCharData
-	Adds a new CharData object to the end of the list.
+	Appends the ASCII value of a character to the data segment.
 
 	Parameters:
-		head - A pointer to the pointer of the head of the CharData list.
-		character - The character to store in the new CharData object.
-		lineNumber - The line number associated with this CharData object.
+		segment - A pointer to the data segment.
+		character - The character to append.
 */
-void addCharData(CharData** head, char character, int lineNumber)
+void addCharData(DataSegment* segment, char character)
 {
-	CharData* newCharData;
-	CharData* current = *head;
-	newCharData = createCharData(character, lineNumber); 
-
-	if (*head == NULL) 
-	{
-		*head = newCharData;
-		return;
-	}
-
-	while (current->next != NULL) 
-	{
-		current = current->next;
-	}
-
-	current->next = newCharData;
+	addDataWord(segment, (unsigned char)character);
 }
 
 /* 
-	Function: printCharDataList
-	Prints the entire CharData list.
+	Function: printDataSegment
+	Prints the entire data segment.
 
 	Parameters:
-		head - A pointer to the head of the CharData list.
+		segment - A pointer to the data segment.
 */
-void printCharDataList(CharData* head)
+void printDataSegment(const DataSegment* segment)
 {
-	CharData* current = head;
-	while (current != NULL)
+	int i;
+	for (i = 0; i < segment->size; i++)
 	{
-		printf("Character: %c\n", current->character);
-		printf("Line Number: %d\n", current->lineNumber);
-		printf("ASCII Value: %d\n", current->asciiValue);
-		current = current->next;
+		printf("DC: %d\n", i);
+		printf("15-bit Binary Representation: ");
+		printBinary(segment->words[i], 15); /* Print as binary */
+		putchar('\n');
 	}
 }
 
-/* 
-	Function: freeCharDataList
-	Frees all memory allocated for the CharData list.
-
-	Parameters:
-		head - A pointer to the head of the CharData list.
-*/
-void freeCharDataList(CharData* head)
-{
-	CharData* current = head;
-	CharData* next;
-	while (current != NULL)
-	{
-		next = current->next;
-		free(current);
-		current = next;
-	}
-}
 
 /* 
 	Function: isValidNumber
@@ -224,6 +111,7 @@ int isValidNumber(int number)
 	Function: isValidString
 	Checks if the provided line is a valid string according to specific rules.
 	A valid string must start and end with double quotes.
+	The line is checked in place, ignoring the white spaces around it.
 
 	Parameters:
 		line - The line to validate.
@@ -235,86 +123,74 @@ int isValidNumber(int number)
 */
 int isValidString(const char* line, int lineNumber, char* file_name)
 {
-	/* Create a modifiable copy of the input line */
-	char* trimmedLine = my_strdup(line);
+	const char* start = line;
+	const char* end = line + strlen(line);
 	int length;
-	if (trimmedLine == NULL)
-	{
-		fprintf(stderr, "Unable to allocate memory for trimmed line\n");
-		exit(EXIT_FAILURE);
-	}
 
-	/* Trim leading and trailing white spaces */
-	trim_whitespace_start(trimmedLine);
-	trim_whitespace_end(trimmedLine);
+	/* Skip leading and trailing white spaces */
+	start = skip_class(start, end, CHAR_WHITESPACE);
+	end = skip_class_backward(start, end, CHAR_WHITESPACE);
 
-	length = strlen(trimmedLine);
+	length = end - start;
 
 	/* Case: Line is too short to be valid */
 	if (length < 2)
 	{
 		printError(ERROR_LINE_TOO_SHORT, lineNumber, file_name);
-		free(trimmedLine);
 		return 1;
 	}
 
 	/* Check if the first and last characters are double quotes */
-	if (trimmedLine[0] != '"' && trimmedLine[length - 1] != '"')
+	if (start[0] != '"' && start[length - 1] != '"')
 	{
 		printError(ERROR_MISSING_DOUBLE_QUOTES, lineNumber, file_name);
-		free(trimmedLine);
 		return 1;
 	}
 
 	/* Case 1a: Missing starting double quote, but ending with double quote */
-	if (trimmedLine[0] != '"' && trimmedLine[length - 1] == '"')
+	if (start[0] != '"' && start[length - 1] == '"')
 	{
 		printError(ERROR_MISSING_BEGINNING_QUOTE, lineNumber, file_name);
-		free(trimmedLine);
 		return 1;
 	}
 
 	/* Case 1b: Starting with double quote, but missing ending double quote */
-	if (trimmedLine[0] == '"' && trimmedLine[length - 1] != '"')
+	if (start[0] == '"' && start[length - 1] != '"')
 	{
 		printError(ERROR_MISSING_END_QUOTE, lineNumber, file_name);
-		free(trimmedLine);
 		return 1;
 	}
 
 	/* If we reach here, the line starts and ends with double quotes */
-	free(trimmedLine);
 	return 0;
 }
 
 /* 
-	Function: processValidLine
-	Processes a valid line of text by extracting characters and adding them to the CharData list.
+	Function: processValidString
+	Appends the characters between the surrounding double quotes of a valid string,
+	followed by a terminating zero, straight to the data segment.
 
 	Parameters:
-		line - The line of text to process.
-		head - A pointer to the pointer of the head of the CharData list.
-		lineNumber - The line number associated with this line of text.
-
-	Returns:
-		The updated line number after processing.
+		line - The validated string, including its surrounding double quotes.
+		segment - A pointer to the data segment.
 */
-int processValidLine(const char* line, CharData** head, int lineNumber) 
+void processValidString(const char* line, DataSegment* segment) 
 {
-	int i = 0;
+	const char* start = line;
+	const char* end = line + strlen(line);
 
-	while (line[i] != '\0') 
-	{
-		addCharData(head, line[i], lineNumber);
-		lineNumber++;
-		i++;
-	}
-	if (line[i] == '\0')
+	/* Skip the white spaces around the string and its surrounding quotes */
+	start = skip_class(start, end, CHAR_WHITESPACE);
+	end = skip_class_backward(start, end, CHAR_WHITESPACE);
+	start++;
+	end--;
+
+	while (start < end) 
 	{
-		addCharData(head, line[i], lineNumber);
+		addCharData(segment, *start);
+		start++;
 	}
-	lineNumber++;
-	return lineNumber;
+	addCharData(segment, '\0');
 }
 
 /* 
@@ -341,107 +217,119 @@ int isNumber(const char* str)
 }
 
 /* 
- * Process a line of numbers separated by commas.
- * This function processes a line of text containing numbers separated by commas, 
- * ensuring correct formatting and no invalid characters. It also trims unnecessary
- * white spaces and checks for leading/trailing commas and consecutive commas.
+	Function: processNumbers
+	Appends each number of a validated .data line straight to the data segment.
+	The numbers are separated by commas and white spaces, and the line is read in place.
+	Stops at the first number that is out of range.
+
+	Parameters:
+		line - The numbers of the .data directive.
+		segment - A pointer to the data segment.
+		lineNumber - The line number for error reporting.
+		file_name - The name of the file for error reporting.
+
+	Returns:
+		1 if an invalid number was found, otherwise 0.
+*/
+int processNumbers(const char* line, DataSegment* segment, int lineNumber, char* file_name)
+{
+	const char* end = line + strlen(line);
+	int number;
+
+	/* Skip the separators before the first number */
+	line = skip_class(line, end, CHAR_WHITESPACE | CHAR_COMMA);
+
+	while (line != end)
+	{
+		/* Convert the current number to an integer */
+		number = strtol(line, NULL, 10);
+		if (isValidNumber(number))
+		{
+			/* Report error if the number is not valid */
+			printError(ERROR_NOT_VALIED_NUM, lineNumber, file_name);
+			return 1;
+		}
+		addData(segment, number);
+
+		/* Move to the next number */
+		line = scan_to_class(line, end, CHAR_WHITESPACE | CHAR_COMMA);
+		line = skip_class(line, end, CHAR_WHITESPACE | CHAR_COMMA);
+	}
+	return 0;
+}
+
+/* 
+ * Validates a line of numbers separated by commas.
+ * This function checks a line of text containing numbers separated by commas, 
+ * ensuring correct formatting and no invalid characters. It checks for
+ * leading/trailing commas and consecutive commas. The line is checked in place.
  *
  * Parameters:
- * - line: The input line to be processed.
+ * - line: The input line to be checked.
  * - lineNumber: The line number in the file for error reporting.
  * - file_name: The name of the file being processed for error reporting.
- * - no_errors: A pointer to a Boolean flag indicating if any errors occurred.
  *
  * Returns:
- * - A dynamically allocated string with commas replaced by spaces and extra white spaces removed.
- * - NULL if an error occurs.
+ * - 1 if the line is invalid (an error was reported), otherwise 0.
  */
-char* processNumberLine(const char* line, int lineNumber, char *file_name, Bool* no_errors)
+int isValidNumberLine(const char* line, int lineNumber, char *file_name)
 {
-	char* trimmedLine;
-	char* token;
-	char* result;
-	char* rest;
-	char* end;
-	char* currentChar;
-	int resultSize;
+	const char* start = line;
+	const char* end;
+	const char* currentChar;
 	int prevCharWasComma = 0;
-	int length;
-	int commaCount = 0;
-	int numberCount = 0;
 	int isNegativeAllowed = 1;
-	int prevCharWasNumber = 0;
-
-	/* Create a modifiable copy of the input line. */
-	trimmedLine = my_strdup(line);
-	if (trimmedLine == NULL)
-	{
-		fprintf(stderr, "Unable to allocate memory for trimmed line\n");
-		exit(EXIT_FAILURE);
-	}
 
-	/* Trim leading white spaces. */
-	while (isspace((unsigned char)*trimmedLine))
+	/* Skip leading white spaces. */
+	while (isspace((unsigned char)*start))
 	{
-		trimmedLine++;
+		start++;
 	}
-	if (*trimmedLine == '\0')
+	if (*start == '\0')
 	{
-		free(trimmedLine);
 		printError(ERROR_INVALID_FORMAT, lineNumber, file_name);
-		*no_errors = FALSE;
-		return NULL;
+		return 1;
 	}
 
-	/* Trim trailing white spaces. */
-	end = trimmedLine + strlen(trimmedLine) - 1;
-	while (isspace((unsigned char)*end) && end > trimmedLine)
+	/* Skip trailing white spaces, end points at the last character. */
+	end = start + strlen(start) - 1;
+	while (isspace((unsigned char)*end) && end > start)
 	{
 		end--;
 	}
-	*(end + 1) = '\0';
 
 	/* Check for a leading comma. */
-	if (trimmedLine[0] == ',')
+	if (*start == ',')
 	{
-		free(trimmedLine);
 		printError(ERROR_LEADING_COMMA, lineNumber, file_name);
-		*no_errors = FALSE;
-		return NULL;
+		return 1;
 	}
 
 	/* Check for a trailing comma. */
-	if (trimmedLine[strlen(trimmedLine) - 1] == ',')
+	if (*end == ',')
 	{
-		free(trimmedLine);
 		printError(ERROR_TRAILING_COMMA, lineNumber, file_name);
-		*no_errors = FALSE;
-		return NULL;
+		return 1;
 	}
 
 	/* Check for invalid characters. */
-	currentChar = trimmedLine;
-	while (*currentChar)
+	for (currentChar = start; currentChar <= end; currentChar++)
 	{
 		if (*currentChar == '-')
 		{
 			if (!isNegativeAllowed)
 			{
 				/* Negative sign should only be at the start of the number or after a comma */
-				free(trimmedLine);
 				printError(ERROR_NOT_A_NUMBER, lineNumber, file_name);
-				*no_errors = FALSE;
-				return NULL;
+				return 1;
 			}
 			isNegativeAllowed = 0; /* Disable negative sign for subsequent characters */
 		}
 		else if (!isdigit((unsigned char)*currentChar) && !isspace((unsigned char)*currentChar) && *currentChar != ',')
 		{
 			/* Invalid character found */
-			free(trimmedLine);
 			printError(ERROR_NOT_A_NUMBER, lineNumber, file_name);
-			*no_errors = FALSE;
-			return NULL;
+			return 1;
 		} 
 		else if (*currentChar == ',')
 		{
@@ -449,10 +337,8 @@ char* processNumberLine(const char* line, int lineNumber, char *file_name, Bool*
 			isNegativeAllowed = 1;
 			if (prevCharWasComma)
 			{
-				free(trimmedLine);
 				printError(ERROR_CONSECUTIVE_COMMAS, lineNumber, file_name);
-				*no_errors = FALSE;
-				return NULL; /* Consecutive commas detected */
+				return 1; /* Consecutive commas detected */
 			}
 		}
 		else
@@ -461,90 +347,7 @@ char* processNumberLine(const char* line, int lineNumber, char *file_name, Bool*
 			isNegativeAllowed = 1;
 		}
 		prevCharWasComma = (*currentChar == ',');
-		prevCharWasNumber = isdigit((unsigned char)*currentChar);
-		currentChar++;
-	}
-
-	/* Check if the number of commas is correct */
-	if (commaCount < numberCount - 1 && numberCount != 2)
-	{
-		free(trimmedLine);
-		printError(ERROR_MISSING_COMMA, lineNumber, file_name);
-		return NULL; /* Missing commas between numbers */
-	}
-
-	/* Allocate memory for the formatted result. */
-	resultSize = strlen(trimmedLine) + 1; /* +1 for spaces */
-	result = (char*)malloc(resultSize);
-	if (result == NULL)
-	{
-		fprintf(stderr, "Unable to allocate memory for result\n");
-		free(trimmedLine);
-		exit(EXIT_FAILURE);
-	}
-
-	/* Create the formatted result with spaces instead of commas. */
-	result[0] = '\0'; /* Initialize the result string */
-	rest = trimmedLine; /* Reset the rest pointer */
-	token = strtok(rest, ",");
-	while (token != NULL)
-	{
-		/* Remove unnecessary white spaces */
-		while (isspace((unsigned char)*token))
-		{
-			token++;
-		}
-		end = token + strlen(token) - 1;
-		while (isspace((unsigned char)*end) && end > token)
-		{
-			end--;
-		}
-		*(end + 1) = '\0';
-
-		/* Append token and a space to result */
-		strcat(result, token);
-		strcat(result, " ");
-
-		/* Get next token */
-		token = strtok(NULL, ",");
-	}
-
-	/* Remove the trailing space */
-	length = strlen(result);
-	if (length > 0 && result[length - 1] == ' ')
-	{
-		result[length - 1] = '\0';
-	}
-
-	free(trimmedLine);
-	return result;
-}
-
-/* 
- * Removes the surrounding double quotes from a given string.
- * This function removes the leading and trailing double quotes from a string,
- * allocating a new string with the quotes removed.
- *
- * Parameters:
- * - str: The input string with surrounding double quotes.
- *
- * Returns:
- * - A new dynamically allocated string with the surrounding quotes removed.
- */
-char* removeQuotes(const char* str)
-{
-	int length = strlen(str);
-
-	char* newStr = (char*)malloc(length - 1);
-	if (newStr == NULL)
-	{
-		fprintf(stderr, "Unable to allocate memory\n");
-		exit(EXIT_FAILURE);
 	}
 
-	strncpy(newStr, str + 1, length - 3);
-	newStr[length - 3] = '\0';
-
-	return newStr;
+	return 0;
 }
-
@@ -6,20 +6,17 @@
  * Initialize the EntryList
  * 
  * This function initializes an EntryList by setting its capacity to the 
- * initial size, its size to 0, and allocates memory for the entries array.
+ * initial size, its size to 0, and allocates the entries array from the arena.
  * 
  * Parameters:
  *    - list: A pointer to the EntryList structure to be initialized.
+ *    - arena: The arena that owns the memory of the list.
  */
-void initEntryList(EntryList* list) {
+void initEntryList(EntryList* list, Arena* arena) {
     list->capacity = INITIAL_SIZE;
     list->size = 0;
-    list->entries = (Entry*)malloc(list->capacity * sizeof(Entry));
-    
-    if (list->entries == NULL) {
-        fprintf(stderr, "Unable to allocate memory for EntryList\n");
-        exit(EXIT_FAILURE);
-    }
+    list->arena = arena;
+    list->entries = (Entry*)arena_alloc(arena, list->capacity * sizeof(Entry));
 }
 
 /* 
@@ -37,58 +34,32 @@ void initEntryList(EntryList* list) {
 void addEntry(EntryList* list, const char* labelName, int lineNumber) {
     /* Resize if necessary */
     if (list->size >= list->capacity) {
+        list->entries = (Entry*)arena_grow(list->arena, list->entries,
+                                           list->capacity * sizeof(Entry), list->capacity * 2 * sizeof(Entry));
         list->capacity *= 2;
-        list->entries = (Entry*)realloc(list->entries, list->capacity * sizeof(Entry));
-        
-        if (list->entries == NULL) {
-            fprintf(stderr, "Unable to reallocate memory for EntryList\n");
-            exit(EXIT_FAILURE);
-        }
     }
 
     /* Add new entry */
-    list->entries[list->size].labelName = my_strdup(labelName);
+    list->entries[list->size].labelName = arena_strdup(list->arena, labelName);
     list->entries[list->size].lineNumber = lineNumber;
     list->size++;
 }
 
-/* 
- * Free the EntryList
- * 
- * This function frees the memory allocated for the EntryList, including 
- * all the label names stored in the list.
- * 
- * Parameters:
- *    - list: A pointer to the EntryList structure to be freed.
- */
-void freeEntryList(EntryList* list) {
-    int i;
-    
-    for (i = 0; i < list->size; i++) {
-        free(list->entries[i].labelName);
-    }
-    
-    free(list->entries);
-}
-
 /* 
  * Initialize the ExternList
  * 
  * This function initializes an ExternList by setting its capacity to 10, 
- * its size to 0, and allocates memory for the externs array.
+ * its size to 0, and allocates the externs array from the arena.
  * 
  * Parameters:
  *    - list: A pointer to the ExternList structure to be initialized.
+ *    - arena: The arena that owns the memory of the list.
  */
-void initExternList(ExternList* list) {
+void initExternList(ExternList* list, Arena* arena) {
     list->capacity = 10; 
     list->size = 0;      
-    list->externs = (Extern*)malloc(list->capacity * sizeof(Extern));
-    
-    if (list->externs == NULL) {
-        fprintf(stderr, "Unable to allocate memory for ExternList\n");
-        exit(EXIT_FAILURE);
-    }
+    list->arena = arena;
+    list->externs = (Extern*)arena_alloc(arena, list->capacity * sizeof(Extern));
 }
 
 /* 
@@ -106,47 +77,15 @@ void initExternList(ExternList* list) {
 void addExtern(ExternList* list, const char* labelName, int lineNumber) {
     /* Resize if necessary */
     if (list->size >= list->capacity) {
+        list->externs = (Extern*)arena_grow(list->arena, list->externs,
+                                            list->capacity * sizeof(Extern), list->capacity * 2 * sizeof(Extern));
         list->capacity *= 2; 
-        list->externs = (Extern*)realloc(list->externs, list->capacity * sizeof(Extern));
-        
-        if (list->externs == NULL) {
-            fprintf(stderr, "Unable to reallocate memory for ExternList\n");
-            exit(EXIT_FAILURE);
-        }
     }
 
     /* Add new extern */
-    list->externs[list->size].labelName = my_strdup(labelName); 
-    
-    if (list->externs[list->size].labelName == NULL) {
-        fprintf(stderr, "Unable to allocate memory for labelName\n");
-        exit(EXIT_FAILURE);
-    }
+    list->externs[list->size].labelName = arena_strdup(list->arena, labelName); 
     
     list->externs[list->size].lineNumber = lineNumber;
     list->size++;
 }
 
-/* 
- * Free the ExternList
- * 
- * This function frees the memory allocated for the ExternList, including 
- * all the label names stored in the list. It also sets the list's size and 
- * capacity to 0.
- * 
- * Parameters:
- *    - list: A pointer to the ExternList structure to be freed.
- */
-void freeExternList(ExternList* list) {
-    int i;
-    
-    for (i = 0; i < list->size; i++) {
-        free(list->externs[i].labelName); 
-    }
-    
-    free(list->externs); 
-    list->externs = NULL; 
-    list->size = 0;       
-    list->capacity = 0;   
-}
-
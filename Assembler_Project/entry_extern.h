@@ -6,6 +6,8 @@
 #include <string.h>
 #include <ctype.h>
 
+#include "arena.h"
+
 #define INITIAL_SIZE 10
 
 /* Structure to represent an entry in the EntryList */
@@ -19,6 +21,7 @@ typedef struct {
     Entry* entries;     /* Array of entries */
     int size;           /* Number of entries currently in the list */
     int capacity;       /* Total capacity of the list */
+    Arena* arena;       /* Arena the list allocates from */
 } EntryList;
 
 /* Structure to represent an external label in the ExternList */
@@ -32,24 +35,19 @@ typedef struct {
     Extern* externs;    /* Array of externs */
     int size;           /* Number of externs currently in the list */
     int capacity;       /* Total capacity of the list */
+    Arena* arena;       /* Arena the list allocates from */
 } ExternList;
 
-/* Initialize the EntryList */
-void initEntryList(EntryList* list);
+/* Initialize the EntryList, allocating from the given arena */
+void initEntryList(EntryList* list, Arena* arena);
 
 /* Add an entry to the EntryList */
 void addEntry(EntryList* list, const char* labelName, int lineNumber);
 
-/* Free the EntryList */
-void freeEntryList(EntryList* list);
-
-/* Initialize the ExternList */
-void initExternList(ExternList* list);
+/* Initialize the ExternList, allocating from the given arena */
+void initExternList(ExternList* list, Arena* arena);
 
 /* Add an extern to the ExternList */
 void addExtern(ExternList* list, const char* labelName, int lineNumber);
 
-/* Free the ExternList */
-void freeExternList(ExternList* list);
-
 #endif /* ENTRY_EXTERN_H */
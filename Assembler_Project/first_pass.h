@@ -15,27 +15,24 @@
 #define LABEL_MAX_LENGTH 32
 
 /*
-	Function: openfileFirstPast
-	--------------------------
-	Opens the specified file for reading and initializes the necessary structures 
-	for the first pass of the assembler.
+	Function: firstPass
+	-------------------
+	Runs the first pass of the assembler over the source of a file after macro expansion.
 	
 	Parameters:
-		file_name - The name of the file to open.
+		source - Pointer to the expanded source of the file.
+		file_name - The name of the file being processed.
 		IC - Pointer to the Instruction Counter.
-		DC - Pointer to the Data Counter.
-		labels - Pointer to the list of labels.
+		labels - Pointer to the symbol table of labels.
 		externList - Pointer to the list of external labels.
 		entryList - Pointer to the list of entry labels.
-		head - Pointer to the head of the data list.
-		headChar - Pointer to the head of the character data list.
-		instructionArray - Pointer to the array of instructions.
-		label_list_used - Pointer to the list of used labels.
+		dataSegment - Pointer to the data segment (its size is the Data Counter).
+		program - Pointer to the program the statements of the source are appended to.
 
 	Returns:
-		Bool - TRUE if the file was successfully opened and processed; otherwise FALSE.
+		Bool - TRUE if the source was processed without errors; otherwise FALSE.
 */
-Bool openfileFirstPast(char *file_name, int* IC, int* DC, LabelNode** labels, ExternList* externList, EntryList* entryList, Data** head, CharData** headChar, InstructionArray* instructionArray, Node** label_list_used);
+Bool firstPass(const ExpandedSource* source, char *file_name, int* IC, SymbolTable* labels, ExternList* externList, EntryList* entryList, DataSegment* dataSegment, Program* program);
 
 /*
 	Function: processLine
@@ -43,22 +40,19 @@ Bool openfileFirstPast(char *file_name, int* IC, int* DC, LabelNode** labels, Ex
 	Processes a single line from the input file during the first pass of the assembler.
 	
 	Parameters:
-		file - The file pointer to the input file.
+		source - Pointer to the expanded source of the file.
 		file_name - The name of the file being processed.
 		IC - Pointer to the Instruction Counter.
-		DC - Pointer to the Data Counter.
-		labels - Pointer to the list of labels.
+		labels - Pointer to the symbol table of labels.
 		externList - Pointer to the list of external labels.
 		entryList - Pointer to the list of entry labels.
-		head - Pointer to the head of the data list.
-		headChar - Pointer to the head of the character data list.
-		instructionArray - Pointer to the array of instructions.
-		label_list_used - Pointer to the list of used labels.
+		dataSegment - Pointer to the data segment (its size is the Data Counter).
+		program - Pointer to the program the statements of the source are appended to.
 
 	Returns:
 		Bool - TRUE if the line was successfully processed; otherwise FALSE.
 */
-Bool processLine(FILE* file, char *file_name , int* IC, int* DC, LabelNode** labels, ExternList * externList, EntryList* entryList, Data** head, CharData** headChar, InstructionArray * instructionArray, Node** label_list_used);
+Bool processLine(const ExpandedSource* source, char *file_name , int* IC, SymbolTable* labels, ExternList * externList, EntryList* entryList, DataSegment* dataSegment, Program* program);
 
 /*
 	Function: isValidOperation
@@ -1,4 +1,11 @@
+#include <pthread.h>
+
 #include "general_functions.h"
+#include "char_class.h"
+
+static pthread_key_t errorStreamKey;                         /* Per-thread error stream */
+static pthread_key_t outputStreamKey;                        /* Per-thread report stream */
+static pthread_once_t streamKeysOnce = PTHREAD_ONCE_INIT;    /* Creates the keys once */
 
 /* Array of error messages corresponding to various error types */
 const char* errorMessages[] = {
@@ -63,108 +70,145 @@ const char* errorMessages[] = {
 /* Function to print an error message with its corresponding line number and file name */
 void printError(ErrorType errorType, int lineNumber, char* fileName)
 {
-    fprintf(stderr, "Error: %s at line %d in file %s\n", errorMessages[errorType], lineNumber, fileName);
+    fprintf(errorStream(), "Error: %s at line %d in file %s\n", errorMessages[errorType], lineNumber, fileName);
 }
 
-/* Function to extract and return the first word from a given line of text */
-char* getFirstWord(const char* line)
+/* 
+ * Function to copy the next line of an in-memory source into a buffer.
+ * Like fgets, at most size-1 characters are copied and the newline is kept,
+ * so a longer line is returned in pieces.
+ */
+int readSourceLine(const char** cursor, const char* end, char* line, size_t size)
 {
-    const char* start = line;
-    const char* end;
-    int length;
-    char* firstWord;
+    const char* start = *cursor;
+    const char* newline;
+    size_t length = (size_t)(end - start);
 
-    /* Skip leading whitespace */
-    while (*start && isspace(*start))
+    if (start >= end || size < 2)
     {
-        start++;
+        return 0;
     }
 
-    /* If there is no text left after whitespace, return NULL */
-    if (*start == '\0')
+    if (length > size - 1)
     {
-        return NULL; 
+        length = size - 1;
     }
 
-    end = start;
-
-    /* Find the end of the first word */   
-    while (*end && !isspace(*end))
+    /* Stop after the first newline */
+    newline = memchr(start, '\n', length);
+    if (newline != NULL)
     {
-        end++;
+        length = (size_t)(newline - start) + 1;
     }
 
-    /* Calculate the length of the first word */
-    length = end - start;
-    /* Allocate memory for the first word */
-    firstWord = (char*)malloc((length + 1) * sizeof(char));
-    if (firstWord == NULL)
-    {
-        fprintf(stderr,"Unable to allocate memory");
-        exit(EXIT_FAILURE);
-    }
+    memcpy(line, start, length);
+    line[length] = '\0';
+    *cursor = start + length;
+    return 1;
+}
+
+/* Function to create the keys of the per-thread streams */
+static void createStreamKeys(void)
+{
+    pthread_key_create(&errorStreamKey, NULL);
+    pthread_key_create(&outputStreamKey, NULL);
+}
 
-    /* Copy the first word into the newly allocated memory */
-    strncpy(firstWord, start, length);
-    firstWord[length] = '\0'; /* Add end of string \0 */
+/* 
+ * Function to get the stream the errors of the current thread are written to.
+ * Each worker thread sets its own stream, so the errors of a file are kept together.
+ */
+FILE* errorStream(void)
+{
+    FILE* stream;
 
-    return firstWord;
+    pthread_once(&streamKeysOnce, createStreamKeys);
+    stream = (FILE*)pthread_getspecific(errorStreamKey);
+    return stream != NULL ? stream : stderr;
 }
 
-/* Function to extract and return the remaining line after the first word */
-char* getRemainingLine(const char* line)
+/* Function to set the stream the errors of the current thread are written to */
+void setErrorStream(FILE* stream)
 {
-    const char* start = line;
-    const char* end;
-    int length;
-    char* remainingLine;
+    pthread_once(&streamKeysOnce, createStreamKeys);
+    pthread_setspecific(errorStreamKey, stream);
+}
 
-    /* Skip leading whitespace */
-    while (*start && isspace(*start))
-    {
-        start++;
-    }
+/* 
+ * Function to get the stream the reports of the current thread, such as the statistics, are written to.
+ * Like the error stream, each worker thread sets its own, so the reports come out in the order of the files.
+ */
+FILE* outputStream(void)
+{
+    FILE* stream;
 
-    /* If there is no remaining text, return NULL */
-    if (*start == '\0')
-    {
-        return NULL; 
-    }
+    pthread_once(&streamKeysOnce, createStreamKeys);
+    stream = (FILE*)pthread_getspecific(outputStreamKey);
+    return stream != NULL ? stream : stdout;
+}
+
+/* Function to set the stream the reports of the current thread are written to */
+void setOutputStream(FILE* stream)
+{
+    pthread_once(&streamKeysOnce, createStreamKeys);
+    pthread_setspecific(outputStreamKey, stream);
+}
 
-    end = start;
+/* 
+ * Function to split a line into whitespace-separated tokens that point into the line itself.
+ * Tokens and the gaps between them are a few characters long, so the characters are
+ * classified inline through the character class table rather than with a call per span.
+ */
+int tokenizeLine(const char* line, TokenList* list)
+{
+    const char* current = line;
 
-    /* Find the end of the first word */
-    while (*end && !isspace(*end))
+    list->count = 0;
+    while (list->count < MAX_LINE_TOKENS)
     {
-        end++;
-    }
+        /* Skip whitespace before the next token */
+        while (IS_CHAR_CLASS(*current, CHAR_WHITESPACE))
+        {
+            current++;
+        }
 
-    /* Skip whitespace after the first word */
-    while (*end && isspace(*end))
-    {
-        end++;
-    }
+        /* Stop at the end of the line */
+        if (*current == '\0')
+        {
+            break;
+        }
 
-    /* If there's no text remaining after whitespace, return NULL */
-    if (*end == '\0')
-    {
-        return NULL;
+        /* Record the token and find its end */
+        list->tokens[list->count].start = current;
+        while (*current && !IS_CHAR_CLASS(*current, CHAR_WHITESPACE))
+        {
+            current++;
+        }
+        list->tokens[list->count].length = current - list->tokens[list->count].start;
+        list->count++;
     }
 
-    /* Calculate the length of the remaining text */
-    length = strlen(end);
-    /* Allocate memory for the remaining line */
-    remainingLine = (char*)malloc((length + 1) * sizeof(char));
-    if (remainingLine == NULL)
-    {
-        fprintf(stderr,"Unable to allocate memory");
-        exit(EXIT_FAILURE);
-    }
+    return list->count;
+}
+
+/* Function to check if a token is equal to a NUL-terminated string */
+Bool tokenEquals(const Token* token, const char* text)
+{
+    return (strncmp(token->start, text, token->length) == 0 && text[token->length] == '\0') ? TRUE : FALSE;
+}
 
-    /* Copy the remaining text into the newly allocated memory */
-    strcpy(remainingLine, end);
+/* Function to copy a token into a NUL-terminated buffer */
+void copyToken(const Token* token, char* buffer, size_t size)
+{
+    size_t length = token->length;
 
-    return remainingLine;
+    /* Truncate the token if the buffer is too small */
+    if (length >= size)
+    {
+        length = size - 1;
+    }
+    memcpy(buffer, token->start, length);
+    buffer[length] = '\0';
 }
 
 /* Custom implementation to format a string with 2 parameters */
@@ -191,46 +235,26 @@ void my_snprintf(char *buffer, size_t size, const char *format, const char *para
     }
 }
 
-/* Function to remove the first word from a line and return the remaining line */
-char* removeFirstWord(char* line) 
-{
-    char *space = strchr(line, ' ');  
-    if (space == NULL) {
-        return NULL;
-    }
-
-    memmove(line, space + 1, strlen(space + 1) + 1);
-
-    return line;
-}
-
 /* Function to trim leading whitespace from a string */
 void trim_whitespace_start(char* str) 
 {
-    char *start = str;
+    char *end = str + strlen(str);
 
     /* Find the first non-whitespace character */
-    while (*start == ' ' || *start == '\t' || *start == '\n' || *start == '\r') 
-    {
-        start++;
-    }
+    const char *start = skip_class(str, end, CHAR_WHITESPACE);
 
-    /* Copy the trimmed string back to the start if necessary */
+    /* Move the trimmed string back to the start if necessary (the ranges overlap) */
     if (start != str) 
     {
-        strcpy(str, start);
+        memmove(str, start, end - start + 1);
     }
 }
 
 /* Function to trim trailing whitespace from a string */
 void trim_whitespace_end(char* str) 
 {
-    char* end = str + strlen(str) - 1;
-    while (end >= str && isspace((unsigned char)*end)) 
-    {
-        end--;
-    }
-    *(end + 1) = '\0'; /* Null-terminate the trimmed string */
+    char* end = (char*)skip_class_backward(str, str + strlen(str), CHAR_WHITESPACE);
+    *end = '\0'; /* Null-terminate the trimmed string */
 }
 
 /* Function to duplicate a string, returning a newly allocated copy */
@@ -253,6 +277,64 @@ char* my_strdup(const char* str)
     return copy;
 }
 
+/* 
+ * Function to split a string into tokens separated by any of the delimiters.
+ * Works like strtok, but the position is kept in save_ptr instead of a static variable,
+ * so several files can be tokenized at the same time.
+ */
+char* my_strtok(char* str, const char* delimiters, char** save_ptr)
+{
+    char* token;
+
+    if (str == NULL)
+    {
+        str = *save_ptr;
+    }
+
+    /* Skip leading delimiters */
+    str += strspn(str, delimiters);
+    if (*str == '\0')
+    {
+        *save_ptr = str;
+        return NULL;
+    }
+
+    /* Find the end of the token and terminate it */
+    token = str;
+    str += strcspn(str, delimiters);
+    if (*str != '\0')
+    {
+        *str++ = '\0';
+    }
+    *save_ptr = str;
+    return token;
+}
+
+/* Function to hash a string (FNV-1a) */
+unsigned long hashString(const char* str)
+{
+    unsigned long hash = 2166136261UL;
+    while (*str)
+    {
+        hash ^= (unsigned char)*str++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+/* Function to hash the characters of a string that is not NUL-terminated (FNV-1a, same as hashString) */
+unsigned long hashBytes(const char* str, size_t length)
+{
+    unsigned long hash = 2166136261UL;
+    const char* end = str + length;
+    while (str < end)
+    {
+        hash ^= (unsigned char)*str++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
 /* Function to convert an integer to a 15-bit two's complement binary representation. */
 uint16_t to_15bit_binary(int number) 
 {
@@ -292,21 +374,21 @@ void printBinary(unsigned int value, int bits)
 void trim_whitespace(char* str) 
 {
     char *start = str;
-    char *end = str + strlen(str) - 1;
+    char *end = str + strlen(str);
 
     /* Trim leading whitespace */
-    while (isspace((unsigned char)*start)) start++;
+    start = (char*)skip_class(start, end, CHAR_WHITESPACE);
 
     /* Trim trailing whitespace */
-    while (end > start && isspace((unsigned char)*end)) end--;
+    end = (char*)skip_class_backward(start, end, CHAR_WHITESPACE);
 
     /* Null-terminate the string after the last non-whitespace character */
-    *(end + 1) = '\0';
+    *end = '\0';
 
      /* Copy the trimmed string back to the start if necessary */
         if (start != str) 
     	{
-           memmove(str, start, end - start + 2); /* +1 for null-terminator, +1 for 0-based index */
+           memmove(str, start, end - start + 1); /* +1 for null-terminator */
         }
 }
 
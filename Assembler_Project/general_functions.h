@@ -75,19 +75,75 @@ typedef enum
     TRUE = 1   /**< Represents the boolean true value */
 } Bool;
 
+/* Formats of the statistics reported for each file */
+typedef enum
+{
+    STATS_NONE = 0, /**< No statistics are reported */
+    STATS_TEXT,     /**< One line of human readable text per file */
+    STATS_JSON      /**< One JSON object per line per file */
+} StatsFormat;
+
+/* Where the outputs of each file are written */
+typedef enum
+{
+    STDOUT_NONE = 0, /**< To the .ob, .ent and .ext files next to the source */
+    STDOUT_OBJECT,   /**< The object to stdout, the other outputs are not written */
+    STDOUT_SECTIONS  /**< Every output to stdout, each one in a framed section */
+} StdoutFormat;
+
+/* The command-line options that apply to every file */
+typedef struct 
+{
+    Bool emit_am;           /**< TRUE to also write the source after macro expansion to <name>.am */
+    const char* cache_dir;  /**< Directory of the output cache, or NULL to always assemble */
+    StatsFormat stats;      /**< Format of the statistics reported for each file */
+    StdoutFormat to_stdout; /**< Where the outputs of each file are written */
+    Bool binary;            /**< TRUE to also write the packed binary object to <name>.obj */
+} AssemblerOptions;
+
+/* Maximum number of whitespace-separated tokens in a line of at most 81 characters */
+#define MAX_LINE_TOKENS 41
+
+/* A view of one word inside a line buffer; the word itself is not copied or NUL-terminated */
+typedef struct {
+    const char* start; /**< Pointer to the first character of the word in the line buffer */
+    int length;        /**< Number of characters in the word */
+} Token;
+
+/* The whitespace-separated words of a single line */
+typedef struct {
+    Token tokens[MAX_LINE_TOKENS]; /**< Views of the words, in order */
+    int count;                     /**< Number of words in the line */
+} TokenList;
+
 extern const char* errorMessages[]; /**< Array of error messages for different error types */
 
 /* Prints an error message based on the error type, line number, and file name */
 void printError(ErrorType errorType, int lineNumber, char* fileName);
 
-/* Extracts and returns the first word from a given line */
-char* getFirstWord(const char* line);
+/* Returns the stream the errors of the current thread are written to (stderr unless it was set) */
+FILE* errorStream(void);
+
+/* Sets the stream the errors of the current thread are written to */
+void setErrorStream(FILE* stream);
 
-/* Extracts and returns the remaining line after the first word */
-char* getRemainingLine(const char* line);
+/* Returns the stream the reports of the current thread are written to (stdout unless it was set) */
+FILE* outputStream(void);
 
-/* Removes the first word from a line and returns the modified line */
-char* removeFirstWord(char* line);
+/* Sets the stream the reports of the current thread are written to */
+void setOutputStream(FILE* stream);
+
+/* Splits a line into whitespace-separated tokens without allocating memory, returns the number of tokens */
+int tokenizeLine(const char* line, TokenList* list);
+
+/* Copies the next line of an in-memory source into a buffer like fgets, returns 0 at the end of the source */
+int readSourceLine(const char** cursor, const char* end, char* line, size_t size);
+
+/* Checks if a token is equal to a NUL-terminated string */
+Bool tokenEquals(const Token* token, const char* text);
+
+/* Copies a token into a NUL-terminated buffer, truncating it if the buffer is too small */
+void copyToken(const Token* token, char* buffer, size_t size);
 
 /* Trims trailing whitespace from a string */
 void trim_whitespace_end(char* str);
@@ -98,6 +154,15 @@ void trim_whitespace(char* str);
 /* Trims leading whitespace from a string */
 void trim_whitespace_start(char* str);
 
+/* Hashes a string (FNV-1a), used by the symbol table and the macro table */
+unsigned long hashString(const char* str);
+
+/* Hashes the characters of a string that is not NUL-terminated, giving the same value as hashString */
+unsigned long hashBytes(const char* str, size_t length);
+
+/* Splits a string into tokens like strtok, keeping its position in save_ptr so it is reentrant */
+char* my_strtok(char* str, const char* delimiters, char** save_ptr);
+
 /* Duplicates a string and returns a newly allocated copy */
 char* my_strdup(const char* str);
 
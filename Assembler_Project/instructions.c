@@ -1,105 +1,181 @@
 #include "instructions.h"
 #include "general_functions.h"
 #include "util_instructions.h"
+#include "label.h"
+
+
+/* 
+ * The operations of the machine, in opcode order, as listed in the README:
+ * name, opcode, number of operands, valid destination methods and valid source methods.
+ */
+#define OPERATIONS \
+	OPERATION(mov,   0, TWO_OPERANDS, METHODS_ALL & ~METHOD_IMMEDIATE, METHODS_ALL) \
+	OPERATION(cmp,   1, TWO_OPERANDS, METHODS_ALL,                     METHODS_ALL) \
+	OPERATION(add,   2, TWO_OPERANDS, METHODS_ALL & ~METHOD_IMMEDIATE, METHODS_ALL) \
+	OPERATION(sub,   3, TWO_OPERANDS, METHODS_ALL & ~METHOD_IMMEDIATE, METHODS_ALL) \
+	OPERATION(lea,   4, TWO_OPERANDS, METHODS_ALL & ~METHOD_IMMEDIATE, METHOD_DIRECT) \
+	OPERATION(clr,   5, ONE_OPERAND,  METHODS_ALL & ~METHOD_IMMEDIATE, METHODS_NONE) \
+	OPERATION(not,   6, ONE_OPERAND,  METHODS_ALL & ~METHOD_IMMEDIATE, METHODS_NONE) \
+	OPERATION(inc,   7, ONE_OPERAND,  METHODS_ALL & ~METHOD_IMMEDIATE, METHODS_NONE) \
+	OPERATION(dec,   8, ONE_OPERAND,  METHODS_ALL & ~METHOD_IMMEDIATE, METHODS_NONE) \
+	OPERATION(jmp,   9, ONE_OPERAND,  METHOD_DIRECT | METHOD_INDIRECT_REGISTER, METHODS_NONE) \
+	OPERATION(bne,  10, ONE_OPERAND,  METHOD_DIRECT | METHOD_INDIRECT_REGISTER, METHODS_NONE) \
+	OPERATION(red,  11, ONE_OPERAND,  METHODS_ALL & ~METHOD_IMMEDIATE, METHODS_NONE) \
+	OPERATION(prn,  12, ONE_OPERAND,  METHODS_ALL,                     METHODS_NONE) \
+	OPERATION(jsr,  13, ONE_OPERAND,  METHOD_DIRECT | METHOD_INDIRECT_REGISTER, METHODS_NONE) \
+	OPERATION(rts,  14, NO_OPERANDS,  METHODS_NONE,                    METHODS_NONE) \
+	OPERATION(stop, 15, NO_OPERANDS,  METHODS_NONE,                    METHODS_NONE)
+
+/* The position of each operation in the list, to check that it matches its opcode */
+#define OPERATION(name, code, type, dest, source) OPERATION_INDEX_##name,
+enum { OPERATIONS OPERATIONS_LISTED };
+#undef OPERATION
+
+/* The list must have exactly one operation for every opcode */
+typedef char check_operation_count[OPERATIONS_LISTED == OPERATION_COUNT ? 1 : -1];
+
+/* 
+ * Compile-time checks of each operation against the rules of the machine:
+ * - The opcode is the position of the operation in the list (find_operation relies on it).
+ * - Only the four addressing methods are used.
+ * - An operation has valid methods exactly for the operands it takes.
+ * - Only cmp and prn accept an immediate value as their destination.
+ */
+#define OPERATION(name, code, type, dest, source) \
+	typedef char check_operation_##name[ \
+		((code) == OPERATION_INDEX_##name \
+		 && ((dest) & ~METHODS_ALL) == 0 && ((source) & ~METHODS_ALL) == 0 \
+		 && ((type) == NO_OPERANDS ? (dest) == 0 && (source) == 0 \
+		     : (type) == ONE_OPERAND ? (dest) != 0 && (source) == 0 \
+		     : (dest) != 0 && (source) != 0) \
+		 && (((dest) & METHOD_IMMEDIATE) == 0 || (code) == 1 || (code) == 12)) ? 1 : -1];
+OPERATIONS
+#undef OPERATION
+
+/* 
+ * The table of all operations and their valid addressing methods.
+ * It is the only list of mnemonics in the assembler, and it is indexed by opcode.
+ */
+#define OPERATION(name, code, type, dest, source) {#name, type, dest, source, code},
+const Operation all_operations[OPERATION_COUNT] = 
+{
+	OPERATIONS
+};
+#undef OPERATION
+
+/* 
+ * Finds an operation by its mnemonic without comparing it to every name.
+ * The mnemonics are told apart by their length and first character (and the third
+ * character for cmp/clr, jmp/jsr and red/rts), which gives the index of the only
+ * candidate; a single comparison then confirms it.
+ */
+const Operation *find_operation(const char *name, size_t length)
+{
+	int code = -1;
 
+	if (length == 3)
+	{
+		switch (name[0])
+		{
+			case 'm': code = 0; break;                         /* mov */
+			case 'c': code = name[2] == 'p' ? 1 : 5; break;    /* cmp, clr */
+			case 'a': code = 2; break;                         /* add */
+			case 's': code = 3; break;                         /* sub */
+			case 'l': code = 4; break;                         /* lea */
+			case 'n': code = 6; break;                         /* not */
+			case 'i': code = 7; break;                         /* inc */
+			case 'd': code = 8; break;                         /* dec */
+			case 'j': code = name[2] == 'p' ? 9 : 13; break;   /* jmp, jsr */
+			case 'b': code = 10; break;                        /* bne */
+			case 'r': code = name[2] == 'd' ? 11 : 14; break;  /* red, rts */
+			case 'p': code = 12; break;                        /* prn */
+		}
+	}
+	else if (length == 4 && name[0] == 's')
+	{
+		code = 15;                                             /* stop */
+	}
 
-/* List of operations and their valid addressing methods */
-Operation all_operations[] = 
+	if (code < 0 || memcmp(all_operations[code].name, name, length) != 0)
+	{
+		return NULL;
+	}
+	return &all_operations[code];
+}
+
+/* 
+ * Function to end the parsing of an instruction with errors. The label operands recorded before
+ * the error are kept as an invalid statement, so the second pass still checks that they are defined.
+ */
+static Bool reject_operation(Statement *statement, Program *program)
 {
-    	{"mov", TWO_OPERANDS, {0, 1, 2, 3, -1}, {0, 1, 2, 3, -1},0},
-    	{"cmp", TWO_OPERANDS, {0, 1, 2, 3, -1}, {0, 1, 2, 3, -1},1},
-    	{"add", TWO_OPERANDS, {1, 2, 3, -1}, {0, 1, 2, 3, -1},2},
-    	{"sub", TWO_OPERANDS, {1, 2, 3, -1}, {0, 1, 2, 3, -1},3},
-    	{"lea", TWO_OPERANDS, {1, 2, 3, -1}, {1, -1},4},
-    	{"clr", ONE_OPERAND, {1, 2, 3, -1}, {-1},5},
-    	{"not", ONE_OPERAND, {1, 2, 3, -1}, {-1},6},
-    	{"inc", ONE_OPERAND, {1, 2, 3, -1}, {-1},7},
-    	{"dec", ONE_OPERAND, {1, 2, 3, -1}, {-1},8},
-    	{"jmp", ONE_OPERAND, {1, 2, -1}, {-1},9},
-    	{"bne", ONE_OPERAND, {1, 2, -1}, {-1},10},
-    	{"red", ONE_OPERAND, {1, 2, 3, -1}, {-1},11},
-    	{"prn", ONE_OPERAND, {0, 1, 2, 3, -1}, {-1},12},
-    	{"jsr", ONE_OPERAND, {1, 2, -1}, {-1},13},
-    	{"rts", NO_OPERANDS, {-1}, {-1},14},
-    	{"stop", NO_OPERANDS, {-1}, {-1},15}
-};
+  if (statement->source_mode == METHOD_DIRECT_ADDRESSING || statement->dest_mode == METHOD_DIRECT_ADDRESSING)
+  {
+    statement->kind = STATEMENT_INVALID;
+    statement->length = 0;
+    add_statement(program, statement);
+  }
+  return FALSE;
+}
 
-/*Checks and processes an operation line from the input.*/
-Bool check_operation(char *line, int line_number, int *ic, InstructionArray *instructionArray, Node** head_label, char* file_name) 
+/*Checks an operation line from the input and records it as a statement of the program.*/
+Bool check_operation(const char *line, Statement *statement, int *ic, Program *program, char* file_name) 
 {
+  char text[MAX_LINE_LENGTH + 1]; /* Copy of the line the tokenizer splits */
   char *token;
   char *operation;
   char *source_operand = NULL, *dest_operand = NULL;
   int source_method = 0, dest_method = 0;
-  int i;
   size_t len;
   Bool iscomma = FALSE;
-  Operation *op = NULL;
-  EncodedInstruction encodedInstr;
-  SimpleInstruction simpleInstr;
-  RawInstruction rawInstr;
+  const Operation *op;
+  int line_number = statement->line_number;
   int dst_value = 0;
   int src_value = 0;
   const int MAX_12_BIT = (1 << 12) - 1; /* 32767 */
   const int MIN_12_BIT = -(1 << 12); /* -32768 */
   char *comma_pos;
+  char *save_ptr; /* Position of the tokenizer in the line */
 
 
   /* Extract operation name */
-  token = strtok(line, " \t\n");
-  if (token == NULL) return FALSE;
+  strncpy(text, line, MAX_LINE_LENGTH);
+  text[MAX_LINE_LENGTH] = '\0';
+  token = my_strtok(text, " \t\n", &save_ptr);
+  if (token == NULL) return reject_operation(statement, program);
   operation = token;
 
-  /* Find the operation in the operations list */
-  for (i = 0; i < sizeof(all_operations) / sizeof(all_operations[0]); i++) 
-  {
-    if (strcmp(operation, all_operations[i].name) == 0) 
-    {
-      op = &all_operations[i];
-      break;
-    }
-  }
+  /* Find the operation in the operations table */
+  op = find_operation(operation, strlen(operation));
 
   if (op == NULL) 
   {
     printError(ERROR_NOT_INSTRUCTION, line_number , file_name);
-    return FALSE;
+    return reject_operation(statement, program);
   }
 
-  /* Initialize encoded instruction with ARE set to 100, and other fields set to 0 */
-  encodedInstr.ARE = 4; /* Set ARE to 100 */
-  encodedInstr.destOperand = 0;
-  encodedInstr.srcOperand = 0;
-  encodedInstr.opcode = op->code;
-  /* Initialize simple instruction with ARE set to 100, and other fields set to 0 */
-  simpleInstr.reserved=0;
-  simpleInstr.ARE=4;
-  simpleInstr.srcOperand=0;
-  simpleInstr.destOperand=0;
-  /* Initialize raw instruction with ARE set to 100, and other fields set to 0 */
-  rawInstr.ARE=4;
-  rawInstr.num=0;
+  /* The statement starts at the current instruction counter, its words are encoded by the second pass */
+  statement->kind = STATEMENT_INSTRUCTION;
+  statement->opcode = (unsigned char)op->code;
+  statement->address = *ic;
 
   /* Check based on the operation type */
   switch (op->type) 
   {
     case NO_OPERANDS:
       /* If operation type is NO_OPERANDS, ensure no additional text exists */
-      token = strtok(NULL, " \t\n");
+      token = my_strtok(NULL, " \t\n", &save_ptr);
       if (token != NULL) 
       {
         printError(ERROR_EXTRA_TEXT_AFTER_COMMAND, line_number, file_name);
-        return FALSE;
+        return reject_operation(statement, program);
       }
       *ic += 1; /* Increment instruction counter */
-      
-      /* Add the encoded instruction to the array */   
-      add_detailed_instruction(instructionArray, encodedInstr);
       break;
 
     case ONE_OPERAND:
       /* If operation type is ONE_OPERAND, extract the single operand */
-      token = strtok(NULL, " \t\n");
+      token = my_strtok(NULL, " \t\n", &save_ptr);
       if (token != NULL) 
       {
         trim_whitespace(token);
@@ -109,7 +185,7 @@ Bool check_operation(char *line, int line_number, int *ic, InstructionArray *ins
         if (dest_operand[0] == ',') 
         {
           printError(ERROR_COMMA_BEFORE_OPERAND, line_number, file_name);
-          return FALSE;
+          return reject_operation(statement, program);
         }
 
         /* Check if the last character is a comma */
@@ -117,7 +193,7 @@ Bool check_operation(char *line, int line_number, int *ic, InstructionArray *ins
         if (dest_operand[len - 1] == ',') 
         {
           printError(ERROR_COMMA_AFTER_LAST_OPERAND, line_number, file_name);
-          return FALSE;
+          return reject_operation(statement, program);
         }
 
         /* Determine the addressing method for the destination operand */
@@ -126,31 +202,31 @@ Bool check_operation(char *line, int line_number, int *ic, InstructionArray *ins
         if (dst_value < MIN_12_BIT || dst_value > MAX_12_BIT) 
         {
           printError(ERROR_OUT_OF_RANGE, line_number, file_name);
-          return FALSE;
+          return reject_operation(statement, program);
         }
 
         /* Validate Label (Direct Addressing Method) */
-        if ((dest_method == 1 && !is_valid_label(dest_operand,all_operations))) 
+        if ((dest_method == 1 && !is_valid_label(dest_operand))) 
         {
                 printError(ERROR_NOT_VALIED_FORMAT_FOR_LABEL, line_number, file_name);
-                return FALSE;
+                return reject_operation(statement, program);
         }
 	if( dest_method == -1)
 	{
 				
                 printError(ERROR_INVALID_OPERATION, line_number, file_name);
-                return FALSE;
+                return reject_operation(statement, program);
 	}
         
         /* Ensure the destination method is valid for the operation */
         if (!is_valid_method(dest_method, op->destMethods)) 
         { 
           printError(ERROR_INVALID_OPERAND_TYPE, line_number, file_name); 
-          return FALSE;
+          return reject_operation(statement, program);
         }
 	
 	/* Check for extra operands */
-        token = strtok(NULL, " \t\n");
+        token = my_strtok(NULL, " \t\n", &save_ptr);
         if (token != NULL) 
         {
 	  	trim_whitespace(token);
@@ -158,38 +234,17 @@ Bool check_operation(char *line, int line_number, int *ic, InstructionArray *ins
           		printError(ERROR_COMMA_AFTER_LAST_OPERAND, line_number, file_name);
 		else
           		printError(ERROR_EXTRA_TEXT_AFTER_OPERANDS, line_number, file_name);
-          	return FALSE;
-        }
-
-        if (dest_method == 1)
-        {
-          	append_node(head_label, line_number, dest_operand,(*ic+1));
+          	return reject_operation(statement, program);
         }
-	
-      
-        /* Set destination operand in the encoded instruction */
-        encodedInstr.destOperand = 1 << dest_method;
-
-        /* Add the encoded instruction to the array */
-        add_detailed_instruction(instructionArray, encodedInstr);
-      
 
-        /* Handle register direct or indirect addressing */
-        if (dest_method == 2 || dest_method == 3) 
-        {
-    		simpleInstr.destOperand=dst_value;;
-		addSimpleInstruction(instructionArray, simpleInstr);
-        }
-        else
-        {
-	  rawInstr.num=dst_value;
-          addRawInstruction(instructionArray, rawInstr);
-        }
+        /* Record the destination operand, a label by its symbol id */
+        statement->dest_mode = (signed char)dest_method;
+        statement->dest_value = dest_method == 1 ? internLabel(program->symbols, dest_operand) : dst_value;
       } 
       else 
       {
         printError(ERROR_MISSING_OPERAND, line_number, file_name);
-        return FALSE;
+        return reject_operation(statement, program);
       }
       *ic += 2; /* Increment instruction counter */
       break;
@@ -197,7 +252,7 @@ Bool check_operation(char *line, int line_number, int *ic, InstructionArray *ins
     case TWO_OPERANDS:
 	 
       	/* If operation type is TWO_OPERANDS, extract the first operand */
-      	token = strtok(NULL, " \t\n");
+      	token = my_strtok(NULL, " \t\n", &save_ptr);
       	if (token != NULL)
       	{
         	trim_whitespace(token);
@@ -207,7 +262,7 @@ Bool check_operation(char *line, int line_number, int *ic, InstructionArray *ins
         	if (source_operand[0] == ',') 
         	{
           		printError(ERROR_COMMA_BEFORE_OPERAND, line_number, file_name);
-          		return FALSE;
+          		return reject_operation(statement, program);
         	}
 
         	/* Check if the last character is a comma and remove it */
@@ -226,7 +281,7 @@ Bool check_operation(char *line, int line_number, int *ic, InstructionArray *ins
           		if (iscomma) 
           		{
 				printError(ERROR_COMMA_AFTER_LAST_OPERAND, line_number, file_name);
-				return FALSE;
+				return reject_operation(statement, program);
 			}
             		*comma_pos = '\0'; /* Split the token at the comma */
             		dest_operand = comma_pos + 1;
@@ -238,107 +293,65 @@ Bool check_operation(char *line, int line_number, int *ic, InstructionArray *ins
 			if (src_value < MIN_12_BIT || src_value > MAX_12_BIT) 
         		{
           			printError(ERROR_OUT_OF_RANGE, line_number, file_name);
-          			return FALSE;
+          			return reject_operation(statement, program);
         		}
-   			if ((source_method == 1 && !is_valid_label(source_operand,all_operations))) 
+   			if ((source_method == 1 && !is_valid_label(source_operand))) 
               		{
                 		printError(ERROR_NOT_VALIED_FORMAT_FOR_LABEL, line_number, file_name);
-                		return FALSE;
+                		return reject_operation(statement, program);
               		}
 			if( source_method == -1)
 			{
 				
                 		printError(ERROR_INVALID_OPERATION, line_number, file_name);
-                		return FALSE;
+                		return reject_operation(statement, program);
 			}
 
               		if (!is_valid_method(source_method, op->sourceMethods)) 
               		{
                 		printError(ERROR_INVALID_OPERAND_TYPE, line_number, file_name);
-                		return FALSE;
+                		return reject_operation(statement, program);
              		}
 
-              		if (source_method == 1)
-             		{
-				
-                		append_node(head_label, line_number, source_operand, (*ic+1));
-              		}
-
-              		encodedInstr.srcOperand = 1 << source_method;
+              		/* Record the source operand, a label by its symbol id */
+              		statement->source_mode = (signed char)source_method;
+              		statement->source_value = source_method == 1 ? internLabel(program->symbols, source_operand) : src_value;
     
               		/* Handle the destination operand as usual */
               		dest_method = get_addressing_method(dest_operand, &dst_value);
 			if (dst_value < MIN_12_BIT || dst_value > MAX_12_BIT) 
         		{
           			printError(ERROR_OUT_OF_RANGE, line_number, file_name);
-          			return FALSE;
+          			return reject_operation(statement, program);
         		}
-              		if ((dest_method == 1 && !is_valid_label(dest_operand,all_operations))) 
+              		if ((dest_method == 1 && !is_valid_label(dest_operand))) 
               		{
                 		printError(ERROR_NOT_VALIED_FORMAT_FOR_LABEL, line_number, file_name);
-                		return FALSE;
+                		return reject_operation(statement, program);
               		}
 			if( dest_method == -1)
 			{
 				
                 		printError(ERROR_INVALID_OPERATION, line_number, file_name);
-                		return FALSE;
+                		return reject_operation(statement, program);
 			}
               		if (!is_valid_method(dest_method, op->destMethods)) 
 
               		{
                 		printError(ERROR_INVALID_OPERAND_TYPE, line_number, file_name);
-                		return FALSE;
+                		return reject_operation(statement, program);
               		}
 
-              		if (dest_method == 1)
-              		{
-                		append_node(head_label, line_number, dest_operand, (*ic+2));
-				
-              		}
-			
-              		encodedInstr.destOperand = 1 << dest_method;
-			
-              		/* Add the encoded instruction to the array */
-              		add_detailed_instruction(instructionArray, encodedInstr);
-			
-              		/* Handle register direct or indirect addressing for source */
-              		if (source_method == 2 || source_method == 3) 
-              		{
-				if (dest_method == 2 || dest_method == 3) 
-              			{
-					
-                			simpleInstr.destOperand=dst_value;
-					simpleInstr.srcOperand=src_value;
-					addSimpleInstruction(instructionArray, simpleInstr);
-					*ic+=2;
-					return TRUE;
-              			}
-				else
-				{
-					simpleInstr.srcOperand=src_value;
-					addSimpleInstruction(instructionArray, simpleInstr);
-				}
-			}
-              		else
-              		{
-				rawInstr.num=src_value;
-          			addRawInstruction(instructionArray, rawInstr);
-              		}
+              		/* Record the destination operand, a label by its symbol id */
+              		statement->dest_mode = (signed char)dest_method;
+              		statement->dest_value = dest_method == 1 ? internLabel(program->symbols, dest_operand) : dst_value;
 
-              		/* Handle register direct or indirect addressing for destination */
-              		if (dest_method == 2 || dest_method == 3) 
+              		/* Two register operands share one word */
+              		if ((source_method == 2 || source_method == 3) && (dest_method == 2 || dest_method == 3)) 
               		{
-    
-    				simpleInstr.destOperand=dst_value;
-				addSimpleInstruction(instructionArray, simpleInstr);
-    		
+				*ic += 2;
+				break;
               		}
-              		else
-              		{
-                		rawInstr.num=dst_value;
-          			addRawInstruction(instructionArray, rawInstr);
-              		}	
         	}
         	else
         	{
@@ -348,31 +361,31 @@ Bool check_operation(char *line, int line_number, int *ic, InstructionArray *ins
 			if (src_value < MIN_12_BIT || src_value > MAX_12_BIT) 
         		{
           			printError(ERROR_OUT_OF_RANGE, line_number, file_name);
-          			return FALSE;
+          			return reject_operation(statement, program);
         		}
-          		if ((source_method == 1 && !is_valid_label(source_operand,all_operations))) 
+          		if ((source_method == 1 && !is_valid_label(source_operand))) 
               		{
                 		printError(ERROR_NOT_VALIED_FORMAT_FOR_LABEL, line_number, file_name);
-                		return FALSE;
+                		return reject_operation(statement, program);
               		}
 			if( source_method == -1)
 			{
 				
                 		printError(ERROR_INVALID_OPERATION, line_number, file_name);
-                		return FALSE;
+                		return reject_operation(statement, program);
 			}
           		if (!is_valid_method(source_method, op->sourceMethods)) 
           		{
             			printError(ERROR_INVALID_OPERAND_TYPE, line_number, file_name);
-            			return FALSE;
+            			return reject_operation(statement, program);
           		}
 
           		/* Handle the destination operand */
-          		token = strtok(NULL, " \t\n");
+          		token = my_strtok(NULL, " \t\n", &save_ptr);
           		if (token == NULL) 
           		{	
             			printError(ERROR_MISSING_OPERAND, line_number, file_name);
-            			return FALSE;
+            			return reject_operation(statement, program);
 			}
             		trim_whitespace(token);
             		dest_operand = token;
@@ -383,28 +396,28 @@ Bool check_operation(char *line, int line_number, int *ic, InstructionArray *ins
 				if(iscomma)
 				{
               				printError(ERROR_DUPLICATE_COMMA, line_number, file_name);
-              				return FALSE;
+              				return reject_operation(statement, program);
 				}
 				if(strlen(dest_operand)==1)
 				{
-					token = strtok(NULL, " \t\n");	
+					token = my_strtok(NULL, " \t\n", &save_ptr);	
 					if(token==NULL)
 					{
 						printError(ERROR_MISSING_DEST_OPERAND, line_number, file_name);
-						return FALSE;
+						return reject_operation(statement, program);
 					}
 					trim_whitespace(token);
             				dest_operand = token;
 					if (token[0]==',')
 					{
               					printError(ERROR_DUPLICATE_COMMA, line_number, file_name);
-              					return FALSE;
+              					return reject_operation(statement, program);
 					}
 				}
 				else if(dest_operand[1]==',')
 				{
 					printError(ERROR_DUPLICATE_COMMA, line_number, file_name);
-              				return FALSE;
+              				return reject_operation(statement, program);
 				}
 				else
 					dest_operand++;
@@ -414,7 +427,7 @@ Bool check_operation(char *line, int line_number, int *ic, InstructionArray *ins
 			if(!iscomma)
 			{
 				printError(ERROR_MISSING_COMMA_BETWEEN_OPERANDS, line_number, file_name);
-              			return FALSE;
+              			return reject_operation(statement, program);
 			}
 
             		/* Check if the last character is a comma */
@@ -422,103 +435,66 @@ Bool check_operation(char *line, int line_number, int *ic, InstructionArray *ins
             		if (dest_operand[len - 1] == ',') 
             		{
               			printError(ERROR_COMMA_AFTER_LAST_OPERAND, line_number, file_name);
-              			return FALSE;
+              			return reject_operation(statement, program);
             		}
 
             		dest_method = get_addressing_method(dest_operand, &dst_value);
 			if (dst_value < MIN_12_BIT || dst_value > MAX_12_BIT) 
         		{
           			printError(ERROR_OUT_OF_RANGE, line_number, file_name);
-          			return FALSE;
+          			return reject_operation(statement, program);
         		}
-            		if ((dest_method == 1 && !is_valid_label(dest_operand,all_operations))) 
+            		if ((dest_method == 1 && !is_valid_label(dest_operand))) 
               		{
                 		printError(ERROR_NOT_VALIED_FORMAT_FOR_LABEL, line_number, file_name);
-                		return FALSE;
+                		return reject_operation(statement, program);
               		}
 			if( dest_method == -1)
 			{
 				
                 		printError(ERROR_INVALID_OPERATION, line_number, file_name);
-                		return FALSE;
+                		return reject_operation(statement, program);
 			}
             		if (!is_valid_method(dest_method, op->destMethods)) 
             		{
               			printError(ERROR_INVALID_OPERAND_TYPE, line_number, file_name);
-              			return FALSE;
+              			return reject_operation(statement, program);
             		}
 
 			/* Check for extra operands */
-            		token = strtok(NULL, " \t\n");
+            		token = my_strtok(NULL, " \t\n", &save_ptr);
             		if (token != NULL) 
             		{
               			printError(ERROR_EXTRA_TEXT_AFTER_OPERANDS, line_number, file_name);
-              			return FALSE;
-            		}
-
-			if (source_method == 1)
-          		{
-            			append_node(head_label, line_number, source_operand, *ic+1);
-          		}
-
-            		if (dest_method == 1)
-            		{
-              			append_node(head_label, line_number, dest_operand, *ic+2);
+              			return reject_operation(statement, program);
             		}
 
-			encodedInstr.srcOperand = 1 << source_method;
-            		encodedInstr.destOperand = 1 << dest_method;
-			/*add encoded instruction*/
-            		add_detailed_instruction(instructionArray, encodedInstr);
+			/* Record both operands, a label by its symbol id */
+			statement->source_mode = (signed char)source_method;
+			statement->source_value = source_method == 1 ? internLabel(program->symbols, source_operand) : src_value;
+			statement->dest_mode = (signed char)dest_method;
+			statement->dest_value = dest_method == 1 ? internLabel(program->symbols, dest_operand) : dst_value;
 
-             		/* Handle register direct or indirect addressing for source */
-              		if (source_method == 2 || source_method == 3) 
-              		{
-				if (dest_method == 2 || dest_method == 3) 
-              			{
-                			simpleInstr.destOperand=dst_value;
-					simpleInstr.srcOperand=src_value;
-					addSimpleInstruction(instructionArray, simpleInstr);
-					*ic += 2; /* Increment instruction counter */
-      					return TRUE;
-              			}
-				else
-				{
-					simpleInstr.srcOperand=src_value;
-					addSimpleInstruction(instructionArray, simpleInstr);
-				}
+			/* Two register operands share one word */
+			if ((source_method == 2 || source_method == 3) && (dest_method == 2 || dest_method == 3)) 
+			{
+				*ic += 2; /* Increment instruction counter */
+				break;
 			}
-              		else
-              		{
-                		rawInstr.num=src_value;
-          			addRawInstruction(instructionArray, rawInstr);
-              
-              		}
-
-              		/* Handle register direct or indirect addressing for destination */
-              		if (dest_method == 2 || dest_method == 3) 
-              		{
-    
-    				simpleInstr.destOperand=dst_value;
-				addSimpleInstruction(instructionArray, simpleInstr);
-    		
-              		}
-              		else
-              		{
-                		rawInstr.num=dst_value;
-          			addRawInstruction(instructionArray, rawInstr);
-              		}
-     
 			}
 		} 
       		else 
       		{
         		printError(ERROR_MISSING_OPERAND, line_number, file_name);
-        		return FALSE;
+        		return reject_operation(statement, program);
       		}
       		*ic += 3; /* Increment instruction counter */
       		break;
     	}
+
+  	/* Record the instruction with the number of its words */
+  	statement->length = *ic - statement->address;
+  	add_statement(program, statement);
   	return TRUE;
 }
 
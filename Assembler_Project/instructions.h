@@ -9,23 +9,36 @@
 #include "general_functions.h"   /* General utility functions */
 #include "pre_assembler.h"       /* Pre-assembler definitions */
 #include "util_instructions.h"   /* Utility functions for instructions */
+#include "ir.h"                  /* Statements of the parsed program */
 
-/* Declaration of the array containing operation definitions */
-extern Operation operations[];
+#define OPERATION_COUNT 16 /* Number of operations, the opcodes are 0 to 15 */
+
+/* Declaration of the table of all operations, indexed by opcode */
+extern const Operation all_operations[OPERATION_COUNT];
+
+/**
+ * Finds an operation by its mnemonic.
+ *
+ * @param name: The mnemonic, which does not have to be NUL-terminated.
+ * @param length: The number of characters in the mnemonic.
+ *
+ * @return: Pointer to the operation in the operations table, or NULL if the name is not a mnemonic.
+ */
+const Operation *find_operation(const char *name, size_t length);
 
 /**
- * Checks and processes an operation line from the input.
+ * Checks an operation line from the input and appends it to the program as an instruction statement.
+ * The operands are parsed once, here; the words are encoded from the statement by the second pass.
  *
- * @param line: The line of text containing the operation to be checked.
- * @param line_number: The line number where the operation is found.
- * @param ic: Pointer to the instruction counter, updated based on processing.
- * @param instructionArray: Pointer to the array of encoded instructions.
- * @param head_label: Pointer to the head of the linked list of labels.
+ * @param line: The line of text containing the operation to be checked, which is not changed.
+ * @param statement: The statement of the line, with its line number and the label it defines.
+ * @param ic: Pointer to the instruction counter, advanced by the number of words of the instruction.
+ * @param program: Pointer to the program the statement is appended to.
  * @param file_name: The name of the file being processed.
  *
- * @return: TRUE if the operation line is valid and processed successfully, FALSE otherwise.
+ * @return: TRUE if the operation line is valid, FALSE otherwise.
  */
-Bool check_operation(char *line, int line_number, int *ic, InstructionArray *instructionArray, Node** head_label, char* file_name);
+Bool check_operation(const char *line, Statement *statement, int *ic, Program *program, char* file_name);
 
 #endif /* INSTRUCTIONS_H */
 
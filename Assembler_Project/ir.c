@@ -0,0 +1,52 @@
+#include "ir.h"
+
+/* Function to initialize an empty program */
+void init_program(Program *program, struct SymbolTable *symbols, Arena *arena)
+{
+    program->statements = NULL;
+    program->size = 0;
+    program->capacity = 0;
+    program->symbols = symbols;
+    program->reference_count = 0;
+    program->arena = arena;
+}
+
+/* Function to initialize a statement with no operands, no label and no words */
+void init_statement(Statement *statement, StatementKind kind, int line_number)
+{
+    statement->kind = (unsigned char)kind;
+    statement->opcode = 0;
+    statement->source_mode = NO_OPERAND;
+    statement->dest_mode = NO_OPERAND;
+    statement->source_value = 0;
+    statement->dest_value = 0;
+    statement->label = NO_SYMBOL;
+    statement->address = 0;
+    statement->length = 0;
+    statement->line_number = line_number;
+}
+
+/* Function to append a statement to the program, doubling its capacity when it is full */
+void add_statement(Program *program, const Statement *statement)
+{
+    size_t capacity;
+
+    if (program->size >= program->capacity)
+    {
+        capacity = program->capacity == 0 ? PROGRAM_INITIAL_CAPACITY : program->capacity * 2;
+        program->statements = (Statement *)arena_grow(program->arena, program->statements,
+                                                      program->capacity * sizeof(Statement), capacity * sizeof(Statement));
+        program->capacity = capacity;
+    }
+    program->statements[program->size++] = *statement;
+
+    /* Count the label operands, each one is resolved by the second pass */
+    if (statement->source_mode == METHOD_DIRECT_ADDRESSING)
+    {
+        program->reference_count++;
+    }
+    if (statement->dest_mode == METHOD_DIRECT_ADDRESSING)
+    {
+        program->reference_count++;
+    }
+}
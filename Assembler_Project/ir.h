@@ -0,0 +1,108 @@
+#ifndef IR_H
+#define IR_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "general_functions.h"
+#include "arena.h"
+
+#define NO_OPERAND (-1) /* Addressing method of an operand the statement does not have */
+#define NO_SYMBOL (-1)  /* Symbol id of a statement without a label */
+#define METHOD_DIRECT_ADDRESSING 1 /* Addressing method of a label operand, as returned by get_addressing_method */
+#define PROGRAM_INITIAL_CAPACITY 64 /* Initial number of statements (a power of two) */
+
+/* 
+ * Enumeration of the kinds of statements.
+ * - STATEMENT_INSTRUCTION: An operation with its operands.
+ * - STATEMENT_DATA: A .data directive.
+ * - STATEMENT_STRING: A .string directive.
+ * - STATEMENT_EXTERN: An .extern directive.
+ * - STATEMENT_ENTRY: An .entry directive.
+ * - STATEMENT_INVALID: An instruction with errors. It keeps the label operands that were parsed
+ *   before the error, so the second pass still reports the ones that are not defined.
+ */
+typedef enum {
+    STATEMENT_INSTRUCTION,
+    STATEMENT_DATA,
+    STATEMENT_STRING,
+    STATEMENT_EXTERN,
+    STATEMENT_ENTRY,
+    STATEMENT_INVALID
+} StatementKind;
+
+/* 
+ * Structure to represent one statement of the source, as parsed by the first pass.
+ * The records are fixed size, so the program is one contiguous array that later stages walk without the text.
+ * - kind: The kind of the statement (a StatementKind).
+ * - opcode: The operation code of an instruction.
+ * - source_mode: The addressing method of the source operand, or NO_OPERAND.
+ * - dest_mode: The addressing method of the destination operand, or NO_OPERAND.
+ * - source_value: The immediate number or register of the source operand, or the symbol id of a label.
+ * - dest_value: The immediate number or register of the destination operand, or the symbol id of a label.
+ * - label: The symbol id of the label the statement defines or, for .extern and .entry, declares; NO_SYMBOL if none.
+ * - address: The IC of the first word of an instruction, or the index of the first word of a directive in the data segment.
+ * - length: The number of words of the statement.
+ * - line_number: The line of the statement in the expanded source.
+ */
+typedef struct {
+    unsigned char kind;
+    unsigned char opcode;
+    signed char source_mode;
+    signed char dest_mode;
+    int source_value;
+    int dest_value;
+    int label;
+    int address;
+    int length;
+    int line_number;
+} Statement;
+
+struct SymbolTable;
+
+/* 
+ * Structure to represent the parsed program: the statements in source order and the symbols they use.
+ * - statements: The statements.
+ * - size: The number of statements.
+ * - capacity: The allocated capacity for the statements.
+ * - symbols: The symbol table of the file, whose symbol ids the statements hold.
+ * - reference_count: The number of label operands in the statements.
+ * - arena: Arena the statements are allocated from.
+ */
+typedef struct {
+    Statement *statements;
+    size_t size;
+    size_t capacity;
+    struct SymbolTable *symbols;
+    int reference_count;
+    Arena *arena;
+} Program;
+
+/* 
+ * Initializes an empty program.
+ * 
+ * @param program: Pointer to the program to initialize.
+ * @param symbols: The symbol table of the file, which names the labels of the statements.
+ * @param arena: The arena that owns the memory of the program.
+ */
+void init_program(Program *program, struct SymbolTable *symbols, Arena *arena);
+
+/* 
+ * Initializes a statement with no operands, no label and no words.
+ * 
+ * @param statement: Pointer to the statement to initialize.
+ * @param kind: The kind of the statement.
+ * @param line_number: The line of the statement.
+ */
+void init_statement(Statement *statement, StatementKind kind, int line_number);
+
+/* 
+ * Appends a copy of a statement to the end of the program.
+ * 
+ * @param program: Pointer to the program.
+ * @param statement: The statement to append.
+ */
+void add_statement(Program *program, const Statement *statement);
+
+#endif /* IR_H */
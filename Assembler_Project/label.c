@@ -2,44 +2,135 @@
 
 
 
-Label** labels = NULL;
-int size = 0;
-int capacity = 10;
+/* Function to find the slot of a name, or the empty slot where it would be inserted */
+static LabelSlot* findSlot(const Label* labels, LabelSlot* slots, int capacity, const char* name, unsigned long hash)
+{
+	unsigned long mask = (unsigned long)capacity - 1;
+	unsigned long i = hash & mask;
 
+	/* Linear probing until the name or an empty slot is found */
+	while (slots[i].id != EMPTY_SLOT && (slots[i].hash != hash || strcmp(labels[slots[i].id].name, name) != 0))
+	{
+		i = (i + 1) & mask;
+	}
+	return &slots[i];
+}
 
-/* Function to create a new label */
-Label* createLabel(const char* name, int lineNumber, CommandType followingContent)
+/* Function to allocate an array of empty slots from the arena */
+static LabelSlot* allocSlots(Arena* arena, int capacity)
 {
-    	Label* newLabel = (Label*)malloc(sizeof(Label));
-    	if (newLabel == NULL) 
+	LabelSlot* slots = (LabelSlot*)arena_alloc(arena, capacity * sizeof(LabelSlot));
+	int i;
+	for (i = 0; i < capacity; i++)
 	{
-        	fprintf(stderr,"Unable to allocate memory for new label");
-        	exit(EXIT_FAILURE);
-    	}
-    	strncpy(newLabel->name, name, LABEL_MAX_LENGTH - 1);
-    	newLabel->name[LABEL_MAX_LENGTH - 1] = '\0';
-    	newLabel->lineNumber = lineNumber;
-    	newLabel->followingContent = followingContent;
-	
+		slots[i].id = EMPTY_SLOT;
+	}
+	return slots;
+}
+
+/* Function to double the capacity of the symbol table and rehash all names, their ids do not change */
+static void growSymbolTable(SymbolTable* table)
+{
+	int i;
+	int newCapacity = table->capacity * 2;
+	LabelSlot* newSlots = allocSlots(table->arena, newCapacity);
+
+	for (i = 0; i < table->capacity; i++)
+	{
+		if (table->slots[i].id != EMPTY_SLOT)
+		{
+			*findSlot(table->labels, newSlots, newCapacity, table->labels[table->slots[i].id].name, table->slots[i].hash) = table->slots[i];
+		}
+	}
+	table->slots = newSlots;
+	table->capacity = newCapacity;
+}
 
-    	return newLabel;
+/* Function to initialize an empty symbol table */
+void initSymbolTable(SymbolTable* table, Arena* arena)
+{
+	table->capacity = SYMBOL_TABLE_INITIAL_CAPACITY;
+	table->count = 0;
+	table->size = 0;
+	table->arena = arena;
+	table->labels = NULL;
+	table->slots = allocSlots(arena, table->capacity);
 }
 
-/* Function to add a label to the linked list */
-void addLabel(LabelNode** head, Label* newLabel) 
+/* Function to get the symbol id of a name, adding it as not defined the first time it is seen */
+int internLabel(SymbolTable* table, const char* name)
 {
-    	LabelNode* newNode = (LabelNode*)malloc(sizeof(LabelNode));
-    	if (newNode == NULL) 
+	unsigned long hash = hashString(name);
+	LabelSlot* slot = findSlot(table->labels, table->slots, table->capacity, name, hash);
+	Label* label;
+
+	if (slot->id != EMPTY_SLOT)
 	{
-        	fprintf(stderr,"Unable to allocate memory for new label node");
-        	exit(EXIT_FAILURE);
-    	}
-    	newNode->label = newLabel;
-    	newNode->next = *head;
-    	*head = newNode;
+		return slot->id;
+	}
+
+	/* Keep the load factor under 3/4 so probe sequences stay short */
+	if ((table->count + 1) * 4 > table->capacity * 3)
+	{
+		growSymbolTable(table);
+		slot = findSlot(table->labels, table->slots, table->capacity, name, hash);
+	}
+
+	/* The labels array is full whenever the count of names is a power of two, so it doubles then */
+	if (table->count == 0 || (table->count & (table->count - 1)) == 0)
+	{
+		table->labels = (Label*)arena_grow(table->arena, table->labels, table->count * sizeof(Label),
+		                                   (table->count == 0 ? 1 : table->count * 2) * sizeof(Label));
+	}
+	label = &table->labels[table->count];
+	label->name = arena_strdup(table->arena, name);
+	label->defined = FALSE;
+	label->lineNumber = 0;
+	label->followingContent = ERROR;
+	slot->hash = hash;
+	slot->id = table->count;
+	return table->count++;
+}
+
+/* Function to define a label in the symbol table */
+int addLabel(SymbolTable* table, const char* name, int lineNumber, CommandType followingContent)
+{
+	char truncated[LABEL_MAX_LENGTH];
+	Label* label;
+	int id;
+
+	/* Names are kept to the longest label name, like the fixed size names of the labels used to be */
+	strncpy(truncated, name, LABEL_MAX_LENGTH - 1);
+	truncated[LABEL_MAX_LENGTH - 1] = '\0';
+	id = internLabel(table, truncated);
+	label = &table->labels[id];
+	if (!label->defined)
+	{
+		label->defined = TRUE;
+		table->size++;
+	}
+	label->lineNumber = lineNumber;
+	label->followingContent = followingContent;
+
+	return id;
+}
+
+/* Function to look up a label defined in the symbol table */
+Label* findLabel(const SymbolTable* table, const char* name)
+{
+	unsigned long hash;
+	int id;
+
+	if (table->slots == NULL || name[0] == '\0')
+	{
+		return NULL;
+	}
+	hash = hashString(name);
+	id = findSlot(table->labels, table->slots, table->capacity, name, hash)->id;
+	return id != EMPTY_SLOT && table->labels[id].defined ? &table->labels[id] : NULL;
 }
 
-/* Function to print the labels in the linked list */
+/* Function to print a single label */
 void printLabel(const Label* label) 
 {
     	if (label == NULL) 
@@ -73,27 +164,16 @@ void printLabel(const Label* label)
 
 
 /* Function to print label list */
-void printLabelList(const LabelNode* head) {
-    const LabelNode* current = head;
-    while (current != NULL) {
-        printLabel(current->label);
-        printf("\n"); 
-        current = current->next;
+void printLabelList(const SymbolTable* table) {
+    int i;
+    for (i = 0; i < table->count; i++) {
+        if (table->labels[i].defined) {
+            printLabel(&table->labels[i]);
+            printf("\n");
+        }
     }
 }
 
-/* Function to free the memory used by the linked list */
-void freeLabels(LabelNode* head) 
-{
-    	LabelNode* current = head;
-    	while (current != NULL) 	
-	{
-        	LabelNode* next = current->next;
-        	free(current->label);
-        	free(current);
-        	current = next;
-    	}
-}
 
 
 /*checks size of label*/
@@ -108,64 +188,35 @@ int isValidLabel(const char* token,int lineNumber,char *file_name)
 	return 0;
 }
 
-/* Checks if a label exists in the array */
-int labelExists(LabelNode* labels, const char* name)
+/* Checks if a label exists in the symbol table */
+int labelExists(const SymbolTable* labels, const char* name)
 {
-	LabelNode* current = labels;
-    	while (current) 
-	{
-        	if (strcmp(current->label->name, name) == 0) 
-		{
-           		 return 1;
-        	}
-        	current = current->next;
-    	}
-    	return 0;
+	return findLabel(labels, name) != NULL;
 }
 
 /*checks what is the next word*/
-CommandType nextWordType(const char* line, int lineNumber,char *file_name, Bool no_errors)
+CommandType nextWordType(const Token* next, int lineNumber,char *file_name)
 {	
-	char *remainingLine;
-	char * token;
-		 
-    	remainingLine = getRemainingLine(line);
 	/*checks if there is a word after*/
-	if (remainingLine == NULL)
+	if (next == NULL)
 	{
 		printError(ERROR_NOT_VALIED_FORMAT_FOR_LABEL, lineNumber,file_name);
-		no_errors =FALSE;
       		return ERROR;
 	}
 
-	token = getFirstWord(remainingLine);
-	
-	free(remainingLine); 
-
 	/*checks the word */
-	if (token == NULL)
-	{
-        	printError(ERROR_NOT_VALIED_FORMAT_FOR_LABEL, lineNumber,file_name);
-		no_errors =FALSE;
-		return ERROR;
-	}
-	
-	if (strcmp(token, ".data") == 0 || strcmp(token, ".string") == 0)
+	if (tokenEquals(next, ".data") || tokenEquals(next, ".string"))
 	{	
-		free(token);
 		return LABEL;
 	}
 	
-	else if(correctCommand(token)==0)
+	if(find_operation(next->start, next->length) != NULL)
 	{
-		free(token);
 		return INSTRUCTION;
 	}
 	else
 	{
-		free(token);
 		printError(ERROR_NOT_VALIED_FORMAT_FOR_LABEL,lineNumber,file_name);
-		no_errors =FALSE;
 		return ERROR;
 	}
 }
@@ -180,35 +231,7 @@ int endsWithColon(const char* token)
 /*checks if its a type of command*/
 int correctCommand(const char *name)
 {
-	int i;
-	/* Array of string literals (array of pointers to characters)*/
-	const char *commands[] = 
-	{
-	"mov",
-        "cmp",
-        "add",
-        "sub",
-        "lea",
-        "clr",
-        "not",
-        "inc",
-        "dec",
-        "jmp",
-        "bne",
-        "red",
-        "prn",
-        "jsr",
-        "rts",
-        "stop"
-        };
-
-	for (i = 0; i < 16; i++)
-	{    
-        	if(strcmp(name, commands[i]) == 0)
-        	return 0;/*Valid command*/
-    	}
-
-    return 1; /*Invalid command */   
+	return find_operation(name, strlen(name)) != NULL ? 0 : 1;
 }
 
 
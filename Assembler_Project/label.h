@@ -20,37 +20,80 @@ typedef enum {
     ERROR        /* Indicates an error or invalid type */
 } CommandType;
 
-/* Structure to represent a label */
+/* Structure to represent a label, or a name that is only used as an operand until it is defined */
 typedef struct Label {
-    char name[LABEL_MAX_LENGTH];   /* Name of the label */
+    char* name;                    /* Name of the label */
+    Bool defined;                  /* Whether the label is defined in the file */
     int lineNumber;                /* Line number where the label is defined */
     CommandType followingContent;  /* Type of content that follows the label */
 } Label;
 
-/* Structure for a node in a linked list of labels */
-typedef struct LabelNode {
-    Label* label;                /* Pointer to the label structure */
-    struct LabelNode* next;      /* Pointer to the next node in the list */
-} LabelNode;
+/* Initial number of slots in a symbol table (must be a power of two) */
+#define SYMBOL_TABLE_INITIAL_CAPACITY 64
+
+/* No symbol id in a slot of the symbol table */
+#define EMPTY_SLOT (-1)
+
+/* Structure for a slot of the symbol table, which keeps the hash so most probes do not reach the label */
+typedef struct LabelSlot {
+    unsigned long hash;          /* Hash of the name */
+    int id;                      /* Symbol id of the name, EMPTY_SLOT for an empty slot */
+} LabelSlot;
+
+/*
+ * Structure for an open-addressing hash table of labels keyed on the label name.
+ * Every name gets a symbol id, its index in labels, which does not change when the table grows,
+ * so the statements of the program refer to their labels by id.
+ */
+typedef struct SymbolTable {
+    Label* labels;               /* Array of the names, indexed by symbol id */
+    int count;                   /* Number of names, defined or not */
+    int size;                    /* Number of labels defined in the file */
+    LabelSlot* slots;            /* Array of slots, an empty slot has the id EMPTY_SLOT */
+    int capacity;                /* Total number of slots (always a power of two) */
+    Arena* arena;                /* Arena the labels and the slots are allocated from */
+} SymbolTable;
+
+/**
+ * Initializes an empty symbol table.
+ *
+ * @param table: Pointer to the symbol table to initialize.
+ * @param arena: The arena that owns the memory of the table.
+ */
+void initSymbolTable(SymbolTable* table, Arena* arena);
 
 /**
- * Creates a new Label structure.
+ * Gets the symbol id of a name, adding it to the table as not defined the first time it is seen.
+ * The table grows when it becomes too full.
  *
+ * @param table: Pointer to the symbol table.
+ * @param name: The name of the symbol.
+ *
+ * @return: The symbol id, an index into table->labels.
+ */
+int internLabel(SymbolTable* table, const char* name);
+
+/**
+ * Defines a label in the symbol table.
+ *
+ * @param table: Pointer to the symbol table.
  * @param name: The name of the label.
- * @param lineNumber: The line number where the label is defined.
+ * @param lineNumber: The address of the label (IC or DC).
  * @param followingContent: The type of content following the label.
  *
- * @return: A pointer to the newly created Label structure.
+ * @return: The symbol id of the label.
  */
-Label* createLabel(const char* name, int lineNumber, CommandType followingContent);
+int addLabel(SymbolTable* table, const char* name, int lineNumber, CommandType followingContent);
 
 /**
- * Adds a label to the linked list of labels.
+ * Looks up a label defined in the file by name.
+ *
+ * @param table: Pointer to the symbol table.
+ * @param name: The name of the label to find.
  *
- * @param head: Pointer to the head of the linked list.
- * @param newLabel: Pointer to the new Label structure to be added.
+ * @return: A pointer to the label if found, NULL otherwise.
  */
-void addLabel(LabelNode** head, Label* newLabel);
+Label* findLabel(const SymbolTable* table, const char* name);
 
 /**
  * Checks if a label is valid based on its token, line number, and file name.
@@ -64,26 +107,25 @@ void addLabel(LabelNode** head, Label* newLabel);
 int isValidLabel(const char* token, int lineNumber, char *file_name);
 
 /**
- * Checks if a label with the given name already exists in the linked list.
+ * Checks if a label with the given name already exists in the symbol table.
  *
- * @param labels: Pointer to the head of the linked list of labels.
+ * @param labels: Pointer to the symbol table.
  * @param name: The name of the label to be checked.
  *
  * @return: 1 if the label exists, 0 otherwise.
  */
-int labelExists(LabelNode* labels, const char* name);
+int labelExists(const SymbolTable* labels, const char* name);
 
 /**
- * Determines the type of the next word in the line based on its content.
+ * Determines the type of the word that follows a label based on its content.
  *
- * @param line: The line of text to be analyzed.
+ * @param next: The token following the label, or NULL if the label is the last word of the line.
  * @param lineNumber: The line number being processed.
  * @param file_name: The name of the file being processed.
- * @param no_errors: Flag indicating if errors should be reported.
  *
  * @return: The type of the next word (LABEL, INSTRUCTION, or ERROR).
  */
-CommandType nextWordType(const char* line, int lineNumber, char *file_name, Bool no_errors);
+CommandType nextWordType(const Token* next, int lineNumber, char *file_name);
 
 /**
  * Checks if a token ends with a colon ':'.
@@ -111,18 +153,11 @@ int correctCommand(const char *name);
 void printLabel(const Label* label);
 
 /**
- * Prints all labels in the linked list.
- *
- * @param head: Pointer to the head of the linked list of labels.
- */
-void printLabelList(const LabelNode* head);
-
-/**
- * Frees the memory allocated for the linked list of labels.
+ * Prints all labels in the symbol table.
  *
- * @param head: Pointer to the head of the linked list of labels.
+ * @param table: Pointer to the symbol table.
  */
-void freeLabels(LabelNode* head);
+void printLabelList(const SymbolTable* table);
 
 #endif /* LABEL_H */
 
@@ -0,0 +1,112 @@
+#include "object_file.h"
+
+/* The decimal digits of 0..99, two characters each */
+static const char decimal_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/* The octal digits of 0..63 (six bits), two characters each */
+static const char octal_pairs[] =
+    "0001020304050607"
+    "1011121314151617"
+    "2021222324252627"
+    "3031323334353637"
+    "4041424344454647"
+    "5051525354555657"
+    "6061626364656667"
+    "7071727374757677";
+
+/* 
+ * Formats one word line. Addresses of up to four digits and 15-bit words, which is every
+ * line of a valid program, are built from the digit pair tables.
+ * Anything wider falls back to sprintf so the text always matches "%04d %05o\n".
+ */
+size_t format_object_line(char *out, int address, uint16_t word)
+{
+    char *p = out;
+
+    if (address >= 0 && address <= 9999)
+    {
+        memcpy(p, decimal_pairs + (address / 100) * 2, 2);
+        memcpy(p + 2, decimal_pairs + (address % 100) * 2, 2);
+        p += 4;
+    }
+    else
+    {
+        p += sprintf(p, "%04d", address);
+    }
+    *p++ = ' ';
+
+    if (word <= 0x7FFF)
+    {
+        *p++ = (char)('0' + (word >> 12));
+        memcpy(p, octal_pairs + ((word >> 6) & 077) * 2, 2);
+        memcpy(p + 2, octal_pairs + (word & 077) * 2, 2);
+        p += 4;
+    }
+    else
+    {
+        p += sprintf(p, "%05o", (unsigned int)word);
+    }
+    *p++ = '\n';
+
+    return p - out;
+}
+
+/* 
+ * Formats consecutive words, one line per word, with increasing addresses.
+ */
+size_t format_object_words(char *out, int address, const uint16_t *words, size_t count)
+{
+    char *p = out;
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        p += format_object_line(p, address + (int)i, words[i]);
+    }
+    return p - out;
+}
+
+/* 
+ * Formats a run of words through a buffer on the stack, a chunk of lines at a time.
+ */
+static Bool write_object_words(FILE *file, int address, const uint16_t *words, size_t count)
+{
+    char buffer[OBJECT_CHUNK_LINES * OBJECT_LINE_MAX];
+    size_t chunk;
+    size_t length;
+
+    while (count > 0)
+    {
+        chunk = count < OBJECT_CHUNK_LINES ? count : OBJECT_CHUNK_LINES;
+        length = format_object_words(buffer, address, words, chunk);
+        if (fwrite(buffer, 1, length, file) != length)
+        {
+            return FALSE;
+        }
+        address += (int)chunk;
+        words += chunk;
+        count -= chunk;
+    }
+    return TRUE;
+}
+
+/* 
+ * Writes the header, the code image and the data image of an object file. The lines are formatted
+ * in chunks on the stack, so writing the object allocates nothing and cannot run out of memory.
+ */
+Bool write_object_file(FILE *file, const uint16_t *code, size_t code_count, const uint16_t *data, size_t data_count)
+{
+    return fprintf(file, "   %d  %d\n", (int)code_count, (int)data_count) > 0 &&
+           write_object_words(file, OBJECT_CODE_START, code, code_count) &&
+           write_object_words(file, OBJECT_CODE_START + (int)code_count, data, data_count) ? TRUE : FALSE;
+}
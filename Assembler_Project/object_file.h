@@ -0,0 +1,49 @@
+#ifndef OBJECT_FILE_H
+#define OBJECT_FILE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "general_functions.h"
+
+#define OBJECT_CODE_START 100 /* Address of the first word of the code image */
+#define OBJECT_LINE_MAX 24    /* Upper bound on the length of one formatted word line */
+#define OBJECT_CHUNK_LINES 256 /* Lines formatted on the stack before each fwrite of an object file */
+
+/* 
+ * Formats one word line of an object file ("%04d %05o\n") without printf.
+ * 
+ * @param out: The buffer to format into, with room for OBJECT_LINE_MAX characters.
+ * @param address: The address of the word.
+ * @param word: The machine word.
+ * @return: The number of characters written (no terminating NULL is written).
+ */
+size_t format_object_line(char *out, int address, uint16_t word);
+
+/* 
+ * Formats consecutive words into a buffer, one line per word.
+ * 
+ * @param out: The buffer to format into, with room for count * OBJECT_LINE_MAX characters.
+ * @param address: The address of the first word.
+ * @param words: The machine words.
+ * @param count: The number of words.
+ * @return: The number of characters written.
+ */
+size_t format_object_words(char *out, int address, const uint16_t *words, size_t count);
+
+/* 
+ * Writes a whole object file: the header line, the code image starting at
+ * OBJECT_CODE_START and the data image right after it.
+ * The text is formatted on the stack and written OBJECT_CHUNK_LINES lines per fwrite, so nothing is allocated.
+ * 
+ * @param file: The stream of the .ob file.
+ * @param code: The words of the code image.
+ * @param code_count: The number of words in the code image.
+ * @param data: The words of the data image.
+ * @param data_count: The number of words in the data image.
+ * @return: TRUE if the whole file was written, FALSE otherwise.
+ */
+Bool write_object_file(FILE *file, const uint16_t *code, size_t code_count, const uint16_t *data, size_t data_count);
+
+#endif /* OBJECT_FILE_H */
@@ -0,0 +1,250 @@
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "output_cache.h"
+#include "source_file.h"
+
+#define OUTPUT_COUNT 4           /* Number of kinds of output files kept in an entry */
+#define SOURCE_EXTENSION ".as"   /* Extension of the copy of the source, written last to complete an entry */
+#define KEY_LENGTH 64            /* Room for a cache key */
+
+/* The extensions of the output files kept in an entry */
+static const char *const output_extensions[OUTPUT_COUNT] = { ".ob", ".ent", ".ext", ".am" };
+
+static pthread_mutex_t temp_lock = PTHREAD_MUTEX_INITIALIZER;  /* Protects temp_counter */
+static unsigned long temp_counter = 0;                          /* Makes temporary names unique between threads */
+
+/* 
+ * Builds the path "<dir>/<name><extension>", or "<name><extension>" when dir is NULL.
+ * The path is allocated with malloc.
+ */
+static char *make_path(const char *dir, const char *name, const char *extension)
+{
+    size_t length = (dir != NULL ? strlen(dir) + 1 : 0) + strlen(name) + strlen(extension) + 1;
+    char *path = malloc(length);
+
+    if (path == NULL)
+    {
+        fprintf(stderr, "Unable to allocate memory for file names\n");
+        exit(EXIT_FAILURE);
+    }
+    if (dir != NULL)
+    {
+        sprintf(path, "%s/%s%s", dir, name, extension);
+    }
+    else
+    {
+        sprintf(path, "%s%s", name, extension);
+    }
+    return path;
+}
+
+/* 
+ * Builds the key of a source: the hash of its contents, its length and the version of the assembler.
+ */
+static void make_key(char *key, const char *source, size_t length)
+{
+    sprintf(key, "%lx-%lx-v%s", hashBytes(source, length), (unsigned long)length, ASSEMBLER_VERSION);
+}
+
+/* Checks whether a file exists */
+static Bool file_exists(const char *path)
+{
+    return access(path, F_OK) == 0 ? TRUE : FALSE;
+}
+
+/* 
+ * Checks whether a file holds exactly the given contents, so a hash collision is never a hit.
+ */
+static Bool file_equals(const char *path, const char *contents, size_t length)
+{
+    SourceFile file;
+    Bool equal;
+
+    if (!open_source_file(&file, path))
+    {
+        return FALSE;
+    }
+    equal = (file.size == length && (length == 0 || memcmp(file.data, contents, length) == 0)) ? TRUE : FALSE;
+    close_source_file(&file);
+    return equal;
+}
+
+/* 
+ * Writes contents to a file through a temporary file in the same directory that is renamed
+ * over it, so another process or thread never sees a partly written file.
+ */
+static Bool write_atomically(const char *path, const char *contents, size_t length)
+{
+    char suffix[KEY_LENGTH];
+    char *temp_path;
+    FILE *file;
+    Bool written;
+
+    pthread_mutex_lock(&temp_lock);
+    sprintf(suffix, ".tmp%ld-%lu", (long)getpid(), temp_counter++);
+    pthread_mutex_unlock(&temp_lock);
+
+    temp_path = make_path(NULL, path, suffix);
+    file = fopen(temp_path, "wb");
+    if (file == NULL)
+    {
+        free(temp_path);
+        return FALSE;
+    }
+    written = fwrite(contents, 1, length, file) == length ? TRUE : FALSE;
+    if (fclose(file) != 0)
+    {
+        written = FALSE;
+    }
+    if (!written || rename(temp_path, path) != 0)
+    {
+        remove(temp_path);
+        written = FALSE;
+    }
+    free(temp_path);
+    return written;
+}
+
+/* 
+ * Copies a file, atomically when requested. A destination that already holds the same
+ * contents is left alone, so its modification time does not change.
+ */
+static Bool copy_file(const char *from, const char *to, Bool atomic)
+{
+    SourceFile input;
+    FILE *output;
+    Bool copied;
+
+    if (!open_source_file(&input, from))
+    {
+        return FALSE;
+    }
+    if (file_equals(to, input.data, input.size))
+    {
+        copied = TRUE;
+    }
+    else if (atomic)
+    {
+        copied = write_atomically(to, input.data, input.size);
+    }
+    else
+    {
+        output = fopen(to, "wb");
+        copied = output != NULL ? TRUE : FALSE;
+        if (output != NULL)
+        {
+            if (fwrite(input.data, 1, input.size, output) != input.size)
+            {
+                copied = FALSE;
+            }
+            if (fclose(output) != 0)
+            {
+                copied = FALSE;
+            }
+        }
+    }
+    close_source_file(&input);
+    return copied;
+}
+
+/* 
+ * Restores the outputs of an entry whose source copy matches the source exactly.
+ */
+Bool cache_restore(const char *cache_dir, const char *file_name, const char *source, size_t length, Bool emit_am)
+{
+    char key[KEY_LENGTH];
+    char *entry_path;
+    char *output_path;
+    Bool hit;
+    int i;
+
+    make_key(key, source, length);
+
+    /* The entry must be complete and hold the same source */
+    entry_path = make_path(cache_dir, key, SOURCE_EXTENSION);
+    hit = file_equals(entry_path, source, length);
+    free(entry_path);
+    for (i = 0; hit && i < OUTPUT_COUNT; i++)
+    {
+        /* The .ob file is always kept, the .am file only when the source was expanded with --emit-am */
+        if (i == 0 || (emit_am && strcmp(output_extensions[i], ".am") == 0))
+        {
+            entry_path = make_path(cache_dir, key, output_extensions[i]);
+            hit = file_exists(entry_path);
+            free(entry_path);
+        }
+    }
+
+    /* Restore the outputs, or remove the ones the entry does not have */
+    for (i = 0; hit && i < OUTPUT_COUNT; i++)
+    {
+        if (!emit_am && strcmp(output_extensions[i], ".am") == 0)
+        {
+            continue;
+        }
+        entry_path = make_path(cache_dir, key, output_extensions[i]);
+        output_path = make_path(NULL, file_name, output_extensions[i]);
+        if (file_exists(entry_path))
+        {
+            hit = copy_file(entry_path, output_path, FALSE);
+        }
+        else
+        {
+            remove(output_path);
+        }
+        free(entry_path);
+        free(output_path);
+    }
+    return hit;
+}
+
+/* 
+ * Copies the outputs of the file into a new entry, then the source, which completes the entry.
+ */
+void cache_store(const char *cache_dir, const char *file_name, const char *source, size_t length, Bool emit_am)
+{
+    char key[KEY_LENGTH];
+    char *entry_path;
+    char *output_path;
+    Bool stored = TRUE;
+    int i;
+
+    output_path = make_path(NULL, file_name, output_extensions[0]);
+    if (!file_exists(output_path))
+    {
+        free(output_path);
+        return;
+    }
+    free(output_path);
+
+    /* The directory may already exist */
+    mkdir(cache_dir, 0777);
+    make_key(key, source, length);
+
+    for (i = 0; stored && i < OUTPUT_COUNT; i++)
+    {
+        /* An .am file left from an earlier run does not belong to this source */
+        if (!emit_am && strcmp(output_extensions[i], ".am") == 0)
+        {
+            continue;
+        }
+        output_path = make_path(NULL, file_name, output_extensions[i]);
+        if (file_exists(output_path))
+        {
+            entry_path = make_path(cache_dir, key, output_extensions[i]);
+            stored = copy_file(output_path, entry_path, TRUE);
+            free(entry_path);
+        }
+        free(output_path);
+    }
+
+    if (stored)
+    {
+        entry_path = make_path(cache_dir, key, SOURCE_EXTENSION);
+        write_atomically(entry_path, source, length);
+        free(entry_path);
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef OUTPUT_CACHE_H
+#define OUTPUT_CACHE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "general_functions.h"
+
+/* 
+ * Version of the output of the assembler, part of every cache key.
+ * Change it whenever the same source can assemble to different files, so old entries are not reused.
+ */
+#define ASSEMBLER_VERSION "1"
+
+/* 
+ * Restores the outputs of a source file from the cache directory, if the same source was
+ * assembled before. The .ob file and the .ent/.ext files of the entry are written next to the
+ * source; an .ent/.ext file the entry does not have is removed, as a fresh assembly would do.
+ * 
+ * @param cache_dir: The cache directory.
+ * @param file_name: The base name of the file (without extension).
+ * @param source: The contents of the .as file.
+ * @param length: The number of characters in the source.
+ * @param emit_am: TRUE if the .am file is needed too; an entry without one is then a miss.
+ * @return: TRUE on a hit, when the outputs were restored, FALSE otherwise.
+ */
+Bool cache_restore(const char *cache_dir, const char *file_name, const char *source, size_t length, Bool emit_am);
+
+/* 
+ * Stores the outputs of a source file that assembled without errors in the cache directory.
+ * Does nothing if the file has no .ob file. Storing is best effort: an entry that cannot be
+ * written is skipped.
+ * 
+ * @param cache_dir: The cache directory, created if it does not exist.
+ * @param file_name: The base name of the file (without extension).
+ * @param source: The contents of the .as file that was assembled.
+ * @param length: The number of characters in the source.
+ * @param emit_am: TRUE if the .am file was written by this assembly and is stored too.
+ */
+void cache_store(const char *cache_dir, const char *file_name, const char *source, size_t length, Bool emit_am);
+
+#endif /* OUTPUT_CACHE_H */
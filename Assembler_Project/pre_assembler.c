@@ -1,189 +1,172 @@
 #include "pre_assembler.h"
 #include "general_functions.h"
+#include "char_class.h"
 
 
 
 /* 
- * Processes a file with macros by creating temporary and output files. 
- * It handles macro replacements and writes the results to the output file.
+ * Processes a file with macros in a single streaming pass, keeping the expanded
+ * source in memory. The .am file is written only when it is requested.
+ * The file names, the macros and the expanded source are allocated from the arena of the file.
  * 
  */
-Bool macro_file(char *file_name)
+Bool macro_file(char *file_name, SourceFile *input_file, Arena *arena, ExpandedSource *source, Bool emit_am)
 {
     size_t length = strlen(file_name) + 1;  /* Calculate the length for memory allocation */
-    char *input_file_name = malloc(length + END_OF_FILE);  /* Allocate memory for input file name */
-    char *output_file_name = malloc(length + END_OF_FILE);  /* Allocate memory for output file name */
-    char *temp_file_name = malloc(length + END_OF_TEMP_FILE);  /* Allocate memory for temp file name */
-    FILE *input_file;  /* File pointer for reading input file */
+    char *output_file_name;  /* Name of the .am file */
     FILE *output_file;  /* File pointer for writing output file */
-    FILE *temp_file;  /* File pointer for writing temp file */
-    Macro *macro_list = NULL;  /* Pointer to the list of macros */
+    MacroTable macros;  /* Table of the macros defined in the file */
     Bool success;  /* Variable to indicate success of operations */
 
-    /* Create input, output, and temp file names */
-    my_snprintf(input_file_name, (length + 3), "%s%s", file_name, ".as");
-    my_snprintf(output_file_name, (length + 3), "%s%s", file_name, ".am");
-    my_snprintf(temp_file_name, (length + 5), "%s%s", file_name, ".temp");
+    /* Collect the macro definitions and expand the macro calls in one pass */
+    init_macro_table(&macros, arena);
+    success = expand_macros(input_file, source, &macros, file_name);
 
-    /* Open the input file for reading */
-    input_file = fopen(input_file_name, "r");
-    if (input_file == NULL)
-    { 
-        fprintf(stderr, "Error opening input file: %s\n", input_file_name);
-        free(input_file_name);
-        free(output_file_name);
-        free(temp_file_name);
-        return FALSE;
-    }
-
-    /* Open the output file for writing */
-    output_file = fopen(output_file_name, "w");
-    if (output_file == NULL)
+    if (!success)
     {
-        fprintf(stderr, "Error opening output file: %s\n", output_file_name);
-        fclose(input_file);
-        free(input_file_name);
-        free(output_file_name);
-        free(temp_file_name);
         return FALSE;
     }
 
-    /* Open the temp file for writing */
-    temp_file = fopen(temp_file_name, "w");
-    if (temp_file == NULL)
+    /* Write the expanded source to the .am file if requested */
+    if (emit_am)
     {
-        fprintf(stderr, "Error opening temp file: %s\n", temp_file_name);
-        fclose(input_file);
-        fclose(output_file);
-        free(input_file_name);
-        free(output_file_name);
-        free(temp_file_name);
-        return FALSE;
-    }
-
-    /* Initialize macro list */
-    macro_list = NULL;
+        output_file_name = arena_alloc(arena, length + END_OF_FILE);
+        my_snprintf(output_file_name, (length + 3), "%s%s", file_name, ".am");
 
-    /* Write non-macro lines to temp file and handle macros */
-    success = write_non_macro_lines(input_file, temp_file, &macro_list, file_name);
-
-    /* If there were errors, remove the new files and exit */
-    if (!success)
-    {
-        fclose(input_file);
-        fclose(temp_file);
-        fclose(output_file);
-        remove(temp_file_name);
-        remove(output_file_name);
-        free(input_file_name);
-        free(output_file_name);
-        free(temp_file_name);
-        if (macro_list)
+        output_file = fopen(output_file_name, "w");
+        if (output_file == NULL)
         {
-            free_all_macros(macro_list);
+            fprintf(errorStream(), "Error opening output file: %s\n", output_file_name);
+            return FALSE;
         }
-        return FALSE;
-    }
-
-    /* Reopen the temp file for reading */
-    fclose(temp_file);
-    temp_file = fopen(temp_file_name, "r");
-    if (temp_file == NULL)
-    {
-        fprintf(stderr, "Error reopening temp file: %s\n", temp_file_name);
-        fclose(input_file);
+        fwrite(source->text, 1, source->length, output_file);
         fclose(output_file);
-        remove(temp_file_name);
-        remove(output_file_name);
-        free(input_file_name);
-        free(output_file_name);
-        free(temp_file_name);
-        if (macro_list)
-        {
-            free_all_macros(macro_list);
-        }
-        return FALSE;
     }
 
-    /* Replace macros in temp file and write to output file */
-    success = replace_macros_in_file(temp_file, output_file, macro_list);
-
-    if (macro_list)
-    {
-        free_all_macros(macro_list);
-    }
+    return TRUE;
+}
 
-    /* Close all files and remove temp file */
-    fclose(input_file);
-    fclose(output_file);
-    fclose(temp_file);
-    remove(temp_file_name);
 
-    /* Clean up and return success status */
-    if (!success)
-    {
-        remove(temp_file_name);
-        remove(output_file_name);
-        return FALSE;
-    }
 
-    free(input_file_name);
-    free(output_file_name);
-    free(temp_file_name);
 
-    return TRUE;
+/* 
+ * Checks that a line view holds only white spaces.
+ */
+static Bool is_blank(const char *text, const char *end)
+{
+    	return skip_class(text, end, CHAR_WHITESPACE) == end ? TRUE : FALSE;
 }
 
+/* 
+ * Function to take a macro definition from the definition cache when the source continues with the
+ * text of a definition parsed before, usually in an earlier file that includes the same macro library.
+ * Only definitions parsed without errors are cached, so a matching text gives the macro a full parse would.
+ * 
+ * @param input_file: The input file, positioned after the macr line. On a hit it is moved past the endmacr line.
+ * @param view: The macr line.
+ * @param macros: The macro table the macro is added to.
+ * @param skipped: Set to the number of lines after the macr line that were taken from the cache.
+ * @return: TRUE if the definition was taken from the cache, FALSE if it must be parsed.
+ */
+static Bool use_cached_definition(SourceFile *input_file, const SourceLine *view, MacroTable *macros, int *skipped)
+{
+    	const CachedDefinition *cached;
 
+    	if (!view->has_newline)
+    	{
+        	return FALSE;
+    	}
+    	cached = find_cached_definition(view->start, (input_file->data + input_file->size) - view->start, view->length + 1);
 
+    	/* A macro of the same name in this file is left to the parser to report */
+    	if (cached == NULL || find_macro(macros, cached->macro->name, strlen(cached->macro->name)) != NULL)
+    	{
+        	return FALSE;
+    	}
+    	add_shared_macro(macros, cached->macro);
+    	input_file->cursor = view->start + cached->length;
+    	*skipped = cached->line_count - 1;
+    	return TRUE;
+}
 
-/* Function to write non-macro lines to the output file and handle macros */
-Bool write_non_macro_lines(FILE *input_file, FILE *output_file, Macro **macro_list, char* file_name)
+/* 
+ * Function to collect macro definitions and append all other lines to the expanded source,
+ * replacing each macro call with the lines of the macro. A macro must be defined before it is used.
+ * The lines are read as views into the input file; only macro definition lines are copied.
+ */
+Bool expand_macros(SourceFile *input_file, ExpandedSource *source, MacroTable *macros, char* file_name)
 {
 	
-    	char buffer[MAX_LINE_LENGTH + 2]; /* Buffer to hold lines including the newline character and null terminator */
+    	char buffer[MAX_LINE_LENGTH + 2]; /* Buffer to hold a macro definition line including the newline character and null terminator */
+    	SourceLine view;
+    	const char *start;
+    	const char *end;
     	int in_macro = 0;
     	int line_number = 0;
     	Macro *current_macro = NULL;
+	Macro *macro;
 	Bool success = TRUE;
 	char *macro_name_end;
 	char *extra_text;
-	int c;
+	int i;
+	const char *definition_start = NULL; /* Start of the macr line of the current macro */
+	size_t definition_header = 0; /* Length of the macr line of the current macro, with its newline */
+	int definition_lines = 0; /* Number of lines in the current macro, from the macr line */
+	Bool definition_clean = FALSE; /* Whether the current macro was parsed without errors so far */
+	int skipped;
 
     	/* Read lines from the input file */
-    	while (fgets(buffer, sizeof(buffer), input_file) != NULL)
+    	while (next_source_line(input_file, &view))
     	{
 		
 		line_number++;
+		start = view.start;
+		end = view.start + view.length;
 
 		/* Check if the line length exceeds 81 characters (including \n) */
-        	if (strlen(buffer) > MAX_LINE_LENGTH)
+        	if (view.length + (view.has_newline ? 1 : 0) > MAX_LINE_LENGTH)
         	{
            		printError(ERROR_LINE_TOO_LONG, line_number, file_name);
            		success = FALSE;
-            		while ((c = fgetc(input_file)) != EOF && c != '\n');
-            			continue;
+			definition_clean = FALSE;
+            		continue;
         	}
 		
         	/* Skip comment lines */
-        	if (strncmp(buffer, ";", 1) == 0)
+        	if (start < end && *start == ';')
         	{
             		continue;
         	}
 
-		trim_whitespace_start(buffer);
+		/* Skip the leading white spaces */
+		while (start < end && (*start == ' ' || *start == '\t' || *start == '\r'))
+		{
+			start++;
+		}
 
-		/* Check if the string is empty after trimming */
-    		if (buffer[0]=='\0') 
+		/* Check if the line is empty after trimming */
+    		if (start == end) 
         	{
             		continue; /* Skip empty lines */
         	}
 		
         	/* Check for macro definition start */
-        	if (strncmp(buffer, "macr",LENGTH_MACR) == 0)
+        	if (end - start >= LENGTH_MACR && strncmp(start, "macr", LENGTH_MACR) == 0)
         	{
 			
             		char macro_name[MAX_LINE_LENGTH];
+
+			/* A definition parsed before is not parsed again */
+			if (!in_macro && use_cached_definition(input_file, &view, macros, &skipped))
+			{
+				line_number += skipped;
+				continue;
+			}
+
+			/* Copy the definition line, it is parsed as a string */
+			memcpy(buffer, start, end - start);
+			buffer[end - start] = '\0';
+
             		/* Validate macro name */
             		if (sscanf(buffer, "macr %s", macro_name) != 1 || is_valid_macro_name(macro_name))
             		{
@@ -207,7 +190,7 @@ Bool write_non_macro_lines(FILE *input_file, FILE *output_file, Macro **macro_li
             		}
 
             		/* Check for duplicate macro name */
-            		if (find_macro(*macro_list, macro_name))
+            		if (find_macro(macros, macro_name, strlen(macro_name)))
             		{
                 		printError(ERROR_MACRO_ALREADY_EXISTS, line_number,file_name);
 				success = FALSE;
@@ -215,46 +198,55 @@ Bool write_non_macro_lines(FILE *input_file, FILE *output_file, Macro **macro_li
             		}
 			
 			/* Check for extra text after macro name */
+			definition_clean = view.has_newline;
             		extra_text = strstr(buffer, macro_name) + strlen(macro_name);
             		if (*extra_text != '\0' && !is_whitespace(extra_text))
             		{
                 		printError(ERROR_EXTRA_TEXT_AFTER_MACRO, line_number,file_name);
 				success = FALSE;
+				definition_clean = FALSE;
             		}
 
-            		/* Create and add new macro to the list */
-            		current_macro = create_macro(macro_name);
-            		current_macro->next = *macro_list;
-            		*macro_list = current_macro;
+            		/* Create and add new macro to the table */
+            		current_macro = add_macro(macros, macro_name);
             		in_macro = 1;
+			definition_start = view.start;
+			definition_header = view.length + 1;
+			definition_lines = line_number;
         
         	}
         	else if (in_macro)
         	{
             		/* Check for macro definition end */
-            		if (strncmp(buffer, "endmacr", LENGTH_ENDMACR) == 0)
+            		if (end - start >= LENGTH_ENDMACR && strncmp(start, "endmacr", LENGTH_ENDMACR) == 0)
             		{
                 		/* Check for extra text after endmacr */
-                		extra_text = buffer + LENGTH_ENDMACR;
-                		if (*extra_text != '\0' && !is_whitespace(extra_text))
+                		if (!is_blank(start + LENGTH_ENDMACR, end))
                 		{
                     			printError(ERROR_EXTRA_TEXT_AFTER_ENDMACR, line_number,file_name);
 					success = FALSE;
+					definition_clean = FALSE;
                 		}
+
+				/* Cache the definition, from the macr line through this line, for the next files */
+				if (definition_clean && view.has_newline)
+				{
+					cache_definition(definition_start, input_file->cursor - definition_start, definition_header,
+					                 line_number - definition_lines + 1, current_macro);
+				}
                 		in_macro = 0;
                 		current_macro = NULL;
         		}
 			else
             		{
-                		/* Add line to the current macro */
-                		add_line_to_macro(current_macro, buffer); 
+                		/* Add line to the current macro, with its newline */
+                		add_line_to_macro(current_macro, start, (end - start) + (view.has_newline ? 1 : 0)); 
             		}
 		}
-		else if (strncmp(buffer, "endmacr", LENGTH_ENDMACR) == 0)
+		else if (end - start >= LENGTH_ENDMACR && strncmp(start, "endmacr", LENGTH_ENDMACR) == 0)
             	{
                 	/* Check for extra text after endmacr */
-                	extra_text = buffer + LENGTH_ENDMACR;
-               		if (*extra_text != '\0' && !is_whitespace(extra_text))
+               		if (!is_blank(start + LENGTH_ENDMACR, end))
                		{
                  		printError(ERROR_EXTRA_TEXT_AFTER_ENDMACR, line_number,file_name);
 				success = FALSE;
@@ -262,58 +254,28 @@ Bool write_non_macro_lines(FILE *input_file, FILE *output_file, Macro **macro_li
 		}
         	else
         	{
-            		/* Write non-macro lines to the output file */
-            		fputs(buffer, output_file);
+            		/* Trim the white spaces around the line */
+            		start = skip_class(start, end, CHAR_WHITESPACE);
+            		end = skip_class_backward(start, end, CHAR_WHITESPACE);
+
+            		/* Replace a macro call with the lines of the macro */
+            		macro = find_macro(macros, start, end - start);
+            		if (macro != NULL)
+            		{
+                		source->macro_calls++;
+                		for (i = 0; i < macro->line_count; i++)
+                		{
+                    			append_to_source(source, macro->lines[i], strlen(macro->lines[i]));
+                		}
+            		}
+            		else
+            		{
+                		/* Append non-macro lines to the expanded source */
+                		append_to_source(source, start, end - start);
+                		append_to_source(source, "\n", 1);
+            		}
         	}
     	}
+	source->lines_read = line_number;
 	return success;
 }
-
-
-
-
-
-/* 
- * Replaces macros in the input file with their corresponding definitions and writes the result to the output file.
- * 
- */
-Bool replace_macros_in_file(FILE* input_file, FILE* output_file, Macro* macro_list) 
-{
-    char buffer[MAX_LINE_LENGTH];  /* Buffer to hold each line read from the input file */
-    int i;  /* Loop counter */
-    Macro* macro;  /* Pointer to a macro object */
-    char *token;  /* Pointer to the current line of text */
-
-    /* Read each line from the input file */
-    while (fgets(buffer, sizeof(buffer), input_file) != NULL) 
-    {
-        trim_whitespace(buffer);  /* Remove leading and trailing whitespace from the line */
-        token = buffer;  /* Set token to the current line */
-
-        if (token != NULL) 
-        {
-            /* Find the macro corresponding to the current line */
-            macro = find_macro(macro_list, token);
-            
-            if (macro != NULL) 
-            {
-                /* If a macro is found, write its lines to the output file */
-                for (i = 0; i < macro->line_count; i++) 
-                {
-                    fputs(macro->lines[i], output_file);
-                }
-            } 
-            else 
-            {
-                /* If no macro is found, write the original line to the output file */
-                fputs(buffer, output_file);
-                fputc('\n', output_file);  /* Add a newline character after each line */
-            }
-        }
-    }
-    return TRUE;  /* Return TRUE indicating the operation was successful */
-}
-
-
-
-
@@ -7,48 +7,40 @@
 #include <string.h>   /* String manipulation functions */
 #include "general_functions.h"  /* General utility functions */
 #include "util_pre_assembler.h" /* Utility functions specific to the pre-assembler */
+#include "source_file.h"        /* Reading the source file as line views */
 
 /* Define constants for various lengths and file extensions */
 #define MAX_LINE_LENGTH 81         /* Maximum length of a line of text */
 #define END_OF_FILE 3              /* Length of file extension for .as and .am */
-#define END_OF_TEMP_FILE 5         /* Length of file extension for .temp */
 #define LENGTH_MACR 4              /* Length of the string "macro" */
 #define LENGTH_ENDMACR 7           /* Length of the string "endmacro" */
 
 /**
- * Processes a file with macros, creating temporary and output files. 
- * Handles macro replacements and writes results to the output file.
+ * Processes a file with macros in a single pass, keeping the expanded source in memory.
+ * Handles macro replacements and optionally writes the result to the .am file.
  *
  * @param file_name: The base name of the file to be processed (without extension).
+ * @param input_file: Pointer to the opened .as file.
+ * @param arena: The arena that owns the file names, macros and expanded source of the file.
+ * @param source: Pointer to the expanded source to fill.
+ * @param emit_am: TRUE to also write the expanded source to the .am file.
  *
  * @return: TRUE if the processing is successful, otherwise FALSE.
  */
-Bool macro_file(char *file_name);
+Bool macro_file(char *file_name, SourceFile *input_file, Arena *arena, ExpandedSource *source, Bool emit_am);
 
 /**
- * Writes non-macro lines from the input file to the output file and 
- * handles macro definitions, updating the macro list as necessary.
+ * Collects macro definitions from the input file and appends all other lines to the
+ * expanded source, replacing each call of a previously defined macro with its lines.
  *
- * @param input_file: File pointer for reading the input file.
- * @param output_file: File pointer for writing to the output file.
- * @param macro_list: Pointer to the list of macros to be updated.
+ * @param input_file: Pointer to the opened input file, read as line views.
+ * @param source: Pointer to the expanded source to append to.
+ * @param macros: Pointer to the table of macros to be updated.
  * @param file_name: The base name of the file being processed.
  *
  * @return: TRUE if successful, otherwise FALSE.
  */
-Bool write_non_macro_lines(FILE *input_file, FILE *output_file, Macro **macro_list, char* file_name);
-
-/**
- * Replaces macro calls in the input file with their definitions from the macro list 
- * and writes the result to the output file.
- *
- * @param input_file: File pointer for reading the temporary file with macro calls.
- * @param output_file: File pointer for writing the final output file with macros replaced.
- * @param macro_list: List of macros to be used for replacement.
- *
- * @return: TRUE if successful, otherwise FALSE.
- */
-Bool replace_macros_in_file(FILE* input_file, FILE* output_file, Macro* macro_list);
+Bool expand_macros(SourceFile *input_file, ExpandedSource *source, MacroTable *macros, char* file_name);
 
 #endif /* PRE_ASSEMBLER_H */
 
@@ -4,19 +4,16 @@
 
 
 /*If the command type matches a label, the line number is incremented by ic.*/
-void preSecondPass(LabelNode *labels, int ic) {
-    LabelNode *currentNode = labels;  /* Start from the head of the linked list */
+void preSecondPass(SymbolTable *labels, int ic) {
+    int i;
 
-    /* Traverse the linked list */
-    while (currentNode != NULL) {
-        /* Check if the command type following the label is of type LABEL */
-        if (currentNode->label->followingContent == LABEL) {
+    /* Traverse all the names of the symbol table */
+    for (i = 0; i < labels->count; i++) {
+        /* Check if the label is defined and the command type following the label is of type LABEL */
+        if (labels->labels[i].defined && labels->labels[i].followingContent == LABEL) {
             /* Update the line number by adding the instruction counter (ic) */
-            currentNode->label->lineNumber += ic;
+            labels->labels[i].lineNumber += ic;
         }
-
-        /* Move to the next node in the linked list */
-        currentNode = currentNode->next;
     }
 }
 
@@ -24,27 +21,15 @@ void preSecondPass(LabelNode *labels, int ic) {
 
 
 /* 
- * Checks if a label name exists in the label list and returns its line number.
+ * Checks if a label name exists in the symbol table and returns its line number.
  */
-int check_label_name(LabelNode* labels, char* label_name) 
+int check_label_name(SymbolTable* labels, char* label_name) 
 {
-    /* Pointer to traverse the label list */
-    LabelNode* labels_current = labels;
+    /* Look the label up by its name */
+    Label* label = findLabel(labels, label_name);
 
-    /* Traverse the list until the end */
-    while (labels_current != NULL) 
-    {
-        /* Compare label names */
-        if (strcmp(labels_current->label->name, label_name) == 0) 
-        {
-            /* Return the line number if label is found */
-            return labels_current->label->lineNumber;
-        }
-        labels_current = labels_current->next;
-    }
-    
-    /* Return 0 if label is not found */
-    return 0;
+    /* Return the line number if label is found, 0 otherwise */
+    return label != NULL ? label->lineNumber : 0;
 }
 
 /* 
@@ -70,73 +55,164 @@ Bool check_label_extern_name(ExternList* externList, char* label_name)
 }
 
 /* 
- * Processes labels and updates instruction array based on label usage.
+ * Finds what a symbol of the program refers to, looking it up the first time it is used only.
+ * Returns the address of a label defined in the file, SYMBOL_EXTERNAL or SYMBOL_UNDEFINED.
  */
-void check_if_label(LabelNode* labels, Node* label_list_used, InstructionArray* instructionArray, Bool* no_errors, char *file_name, ExternList externList, FILE* ext_file, Bool* is_extern) 
+static int resolve_symbol(SymbolTable* labels, ExternList* externList, const Program* program, int* resolved, int symbol)
 {
-    int num;
-    int current_IC;
-    Instruction* array_list;
-    Node *current = label_list_used;
+    if (resolved[symbol] == SYMBOL_UNRESOLVED)
+    {
+        /* The symbol id is the label itself, only a name that is not defined is looked up */
+        resolved[symbol] = labels->labels[symbol].defined ? labels->labels[symbol].lineNumber : 0;
+        if (resolved[symbol] == 0)
+        {
+            resolved[symbol] = check_label_extern_name(externList, labels->labels[symbol].name) ? SYMBOL_EXTERNAL : SYMBOL_UNDEFINED;
+        }
+    }
+    return resolved[symbol];
+}
+
+/* 
+ * Checks a label operand and, when the instruction is encoded, appends its word.
+ * A defined label gives its relocatable address, an extern label gives an external word that is
+ * listed in the .ext file with its address, and an undefined label is reported.
+ */
+static void encode_label_operand(const Statement* statement, int symbol, int address, InstructionArray* instructionArray, int* resolved,
+                                 SymbolTable* labels, ExternList* externList, const Program* program, Bool* no_errors, char *file_name, FILE* ext_file, Bool* is_extern)
+{
+    RawInstruction rawInstr;
+    int num = resolve_symbol(labels, externList, program, resolved, symbol);
+    Bool emit = statement->kind == STATEMENT_INSTRUCTION ? TRUE : FALSE;
+
+    rawInstr.ARE = ARE_ABSOLUTE;
+    rawInstr.num = 0;
+    if (num == SYMBOL_EXTERNAL)
+    {
+        *is_extern = FALSE;
+        if (emit)
+        {
+            rawInstr.ARE = ARE_EXTERNAL;
+            fprintf(ext_file, "%s %04d\n", labels->labels[symbol].name, address);
+        }
+    }
+    else if (num == SYMBOL_UNDEFINED)
+    {
+        /* Report error if label is undefined */
+        printError(ERROR_UNDEFINED_LABEL, statement->line_number, file_name);
+        *no_errors = FALSE;
+    }
+    else
+    {
+        rawInstr.ARE = ARE_RELOCATABLE;
+        rawInstr.num = num;
+    }
+    if (emit)
+    {
+        addRawInstruction(instructionArray, rawInstr);
+    }
+}
+
+/* 
+ * Encodes the words of the instructions from the statements of the program.
+ * The operands were parsed by the first pass, so only the labels are looked up here.
+ */
+void encode_instructions(SymbolTable* labels, const Program* program, InstructionArray* instructionArray, Bool* no_errors, char *file_name, ExternList* externList, FILE* ext_file, Bool* is_extern)
+{
+    EncodedInstruction encodedInstr;
+    SimpleInstruction simpleInstr;
+    RawInstruction rawInstr;
+    const Statement* statement;
+    int* resolved;
+    int source_register, dest_register;
+    int offset;
+    size_t i;
+    int s;
+
+    /* No symbol is looked up before it is used */
+    resolved = (int *)arena_alloc(program->arena, (labels->count + 1) * sizeof(int));
+    for (s = 0; s < labels->count; s++)
+    {
+        resolved[s] = SYMBOL_UNRESOLVED;
+    }
 
-    /* Iterate over the labels used in instructions */
-    while (current != NULL)
+    for (i = 0; i < program->size; i++)
     {
-        array_list = instructionArray->instructions;
-        num = check_label_name(labels, current->line_text);
+        statement = &program->statements[i];
+        if (statement->kind != STATEMENT_INSTRUCTION && statement->kind != STATEMENT_INVALID)
+        {
+            continue;
+        }
+        source_register = statement->source_mode == 2 || statement->source_mode == 3;
+        dest_register = statement->dest_mode == 2 || statement->dest_mode == 3;
 
-        /* Check if label is defined */
-        if (num != 0)
+        /* The first word holds the operation and the addressing methods of its operands */
+        if (statement->kind == STATEMENT_INSTRUCTION)
         {
-            current_IC = current->ic - 100;
-            /* Traverse the instruction array to find the correct position */
-            while (current_IC != 0 && array_list != NULL)
-            {
-                array_list++;
-                current_IC--;
-            }
-            /* Update instruction if label is found */
-            if (array_list != NULL)
-            {
-                if (array_list->isRaw)
-                {
-                    array_list->instruction.raw.ARE = 2;
-                    array_list->instruction.raw.num = num;
-                }
-            }
+            encodedInstr.ARE = ARE_ABSOLUTE;
+            encodedInstr.opcode = statement->opcode;
+            encodedInstr.srcOperand = statement->source_mode != NO_OPERAND ? 1 << statement->source_mode : 0;
+            encodedInstr.destOperand = statement->dest_mode != NO_OPERAND ? 1 << statement->dest_mode : 0;
+            add_detailed_instruction(instructionArray, encodedInstr);
         }
-        /* Check if label is extern */
-        else if (check_label_extern_name(&externList, current->line_text))
+        simpleInstr.ARE = ARE_ABSOLUTE;
+        simpleInstr.reserved = 0;
+        simpleInstr.srcOperand = 0;
+        simpleInstr.destOperand = 0;
+        rawInstr.ARE = ARE_ABSOLUTE;
+
+        /* The source operand word */
+        offset = 1;
+        if (statement->source_mode == METHOD_DIRECT_ADDRESSING)
         {
-            current_IC = current->ic - 100;
-            *is_extern = FALSE;
-            /* Traverse the instruction array to find the correct position */
-            while (current_IC != 0 && array_list != NULL)
+            encode_label_operand(statement, statement->source_value, statement->address + offset, instructionArray, resolved,
+                                 labels, externList, program, no_errors, file_name, ext_file, is_extern);
+            offset++;
+        }
+        else if (statement->source_mode != NO_OPERAND)
+        {
+            /* Two register operands share one word */
+            if (source_register)
+            {
+                simpleInstr.srcOperand = statement->source_value;
+                simpleInstr.destOperand = dest_register ? statement->dest_value : 0;
+                addSimpleInstruction(instructionArray, simpleInstr);
+            }
+            else
             {
-                array_list++;
-                current_IC--;
+                rawInstr.num = statement->source_value;
+                addRawInstruction(instructionArray, rawInstr);
             }
-            /* Update instruction and write to extern file */
-            if (array_list != NULL)
+            if (source_register && dest_register)
             {
-                array_list->instruction.raw.ARE = 1;
-                fprintf(ext_file, "%s %04d\n", current->line_text, current->ic);
+                continue;
             }
+            offset++;
         }
-        else
+
+        /* The destination operand word */
+        if (statement->dest_mode == METHOD_DIRECT_ADDRESSING)
         {
-            /* Report error if label is undefined */
-            printError(ERROR_UNDEFINED_LABEL, current->line_number, file_name);
-            *no_errors = FALSE;
+            encode_label_operand(statement, statement->dest_value, statement->address + offset, instructionArray, resolved,
+                                 labels, externList, program, no_errors, file_name, ext_file, is_extern);
+        }
+        else if (dest_register)
+        {
+            simpleInstr.srcOperand = 0;
+            simpleInstr.destOperand = statement->dest_value;
+            addSimpleInstruction(instructionArray, simpleInstr);
+        }
+        else if (statement->dest_mode != NO_OPERAND)
+        {
+            rawInstr.num = statement->dest_value;
+            addRawInstruction(instructionArray, rawInstr);
         }
-        current = current->next;
     }
 }
 
 /* 
  * Checks for illegal extern labels by comparing them against the label list.
  */
-void check_alligal_extern_labels(LabelNode** labels, ExternList* externList, Bool* no_errors, char *file_name)
+void check_alligal_extern_labels(SymbolTable* labels, ExternList* externList, Bool* no_errors, char *file_name)
 {
     int i;
     ExternList* current_externList = externList;
@@ -145,7 +221,7 @@ void check_alligal_extern_labels(LabelNode** labels, ExternList* externList, Boo
     for (i = 0; i < externList->size; i++) 
     {
         /* Check if extern label is also defined in the label list */
-        if (check_label_name(*labels, current_externList->externs[i].labelName) != 0) 
+        if (check_label_name(labels, current_externList->externs[i].labelName) != 0) 
         {
             /* Report error for illegal extern label */
             printError(ERROR_EXTERN_LABEL_WAS_DEFINED, current_externList->externs[i].lineNumber, file_name);
@@ -159,7 +235,7 @@ void check_alligal_extern_labels(LabelNode** labels, ExternList* externList, Boo
 /* 
  * Checks all entry labels for validity and writes valid entries to a file.
  */
-void check_alligal_entry_labels(LabelNode** labels, Bool* no_errors, char *file_name, EntryList** entryList, FILE* file_ent)
+void check_alligal_entry_labels(SymbolTable* labels, Bool* no_errors, char *file_name, EntryList** entryList, FILE* file_ent)
 {
     /* Pointer to the current entry list */
     EntryList* current_entryList = *entryList;
@@ -170,7 +246,7 @@ void check_alligal_entry_labels(LabelNode** labels, Bool* no_errors, char *file_
     for (i = 0; i < current_entryList->size; i++) 
     {
         /* Check if the entry label exists in the label list */
-        num = check_label_name(*labels, current_entryList->entries[i].labelName);
+        num = check_label_name(labels, current_entryList->entries[i].labelName);
 
         /* If the label is not found, report an error */
         if (num == 0)
@@ -187,12 +263,52 @@ void check_alligal_entry_labels(LabelNode** labels, Bool* no_errors, char *file_
 }
 
 	
+/* 
+ * Performs the checks of the second pass, encodes the instructions and writes the outputs to the
+ * given streams. The caller decides what to keep of them when there are errors.
+ */
+void secondPassToStreams(char *file_name, int* IC, SymbolTable* labels, ExternList* externList, EntryList** entryList, DataSegment* dataSegment, InstructionArray* instructionArray, const Program* program, Bool* no_errors, FILE* file_ob, FILE* file_ent, FILE* file_ext, Bool* is_extern)
+{
+    preSecondPass(labels, *IC);
+    check_alligal_extern_labels(labels, externList, no_errors, file_name);
+    check_alligal_entry_labels(labels, no_errors, file_name, entryList, file_ent);
+    encode_instructions(labels, program, instructionArray, no_errors, file_name, externList, file_ext, is_extern);
+
+    /* Write instructions and data to the object stream */
+    if (!write_object_file(file_ob, instructionArray->words, instructionArray->size, dataSegment->words, dataSegment->size))
+    {
+        fprintf(errorStream(), "Error writing .ob file: %s.ob\n", file_name);
+        *no_errors = FALSE;
+    }
+    *IC += dataSegment->size;
+
+    /*if there is no room in mommory*/
+    if (*IC > MAX_MOMMORY)
+    {
+        printError(ERROR_NOT_ENOUGH_MOMMORY, MAX_MOMMORY, file_name);
+    }
+}
+
+/* 
+ * Closes the output files that are open and removes all three, after an error.
+ */
+static void discard_outputs(FILE *file_ob, FILE *file_ent, FILE *file_ext, const char *ob_filename, const char *ent_filename, const char *ext_filename)
+{
+    if (file_ob != NULL) fclose(file_ob);
+    if (file_ent != NULL) fclose(file_ent);
+    if (file_ext != NULL) fclose(file_ext);
+    remove(ob_filename);
+    remove(ent_filename);
+    remove(ext_filename);
+}
+
 /* 
  * Processes the second pass of the assembler, opens output files, performs necessary checks,
  * writes results to files, and frees allocated memory.
- * 
+ * The files may be assembled on worker threads, so a file whose outputs cannot be written is
+ * reported and marked as failed instead of ending the program.
  */
-void secondPass(char *file_name, int* IC, int* DC, LabelNode** labels, ExternList* externList, EntryList** entryList, Data** head, CharData** headChar, InstructionArray* instructionArray, Node** label_list_used, Bool* no_errors)
+void secondPass(char *file_name, int* IC, SymbolTable* labels, ExternList* externList, EntryList** entryList, DataSegment* dataSegment, InstructionArray* instructionArray, const Program* program, Bool* no_errors)
 {
     FILE *file_ob, *file_ent, *file_ext;  /* File pointers for writing */
     int length = strlen(file_name);  /* Length of the file name without extension */
@@ -205,8 +321,12 @@ void secondPass(char *file_name, int* IC, int* DC, LabelNode** labels, ExternLis
     /* Check if memory allocation was successful */
     if (ob_filename == NULL || ent_filename == NULL || ext_filename == NULL) 
     {
-        fprintf(stderr, "Unable to allocate memory for file names\n");
-        exit(EXIT_FAILURE);
+        fprintf(errorStream(), "Unable to allocate memory for file names\n");
+        free(ob_filename);
+        free(ent_filename);
+        free(ext_filename);
+        *no_errors = FALSE;
+        return;
     }
 
     /* Build file names with the appropriate extensions */
@@ -214,76 +334,39 @@ void secondPass(char *file_name, int* IC, int* DC, LabelNode** labels, ExternLis
     my_snprintf(ent_filename, length + 5, "%s.ent", file_name, ".ent");
     my_snprintf(ext_filename, length + 5, "%s.ext", file_name, ".ext");
 
-    /* Open .ob file for writing */
+    /* Open the .ob, .ent and .ext files for writing */
     file_ob = fopen(ob_filename, "w");
-    if (file_ob == NULL) 
-    {
-        fprintf(stderr, "Error opening .ob file: %s\n", ob_filename);
-        free(ob_filename);  /* Free allocated memory before exiting */
-        free(ent_filename);
-        free(ext_filename);
-        exit(EXIT_FAILURE);
-    }
-
-    /* Open .ent file for writing */
-    file_ent = fopen(ent_filename, "w");
-    if (file_ent == NULL) 
-    {
-        fprintf(stderr, "Error opening .ent file: %s\n", ent_filename);
-        fclose(file_ob);  /* Close previously opened files */
-        free(ob_filename);
-        free(ent_filename);
-        free(ext_filename);
-        exit(EXIT_FAILURE);
-    }
-
-    /* Open .ext file for writing */
-    file_ext = fopen(ext_filename, "w");
+    file_ent = file_ob != NULL ? fopen(ent_filename, "w") : NULL;
+    file_ext = file_ent != NULL ? fopen(ext_filename, "w") : NULL;
     if (file_ext == NULL) 
     {
-        fprintf(stderr, "Error opening .ext file: %s\n", ext_filename);
-        fclose(file_ob);  /* Close previously opened files */
-        fclose(file_ent);
+        if (file_ob == NULL)
+        {
+            fprintf(errorStream(), "Error opening .ob file: %s\n", ob_filename);
+        }
+        else if (file_ent == NULL)
+        {
+            fprintf(errorStream(), "Error opening .ent file: %s\n", ent_filename);
+        }
+        else
+        {
+            fprintf(errorStream(), "Error opening .ext file: %s\n", ext_filename);
+        }
+        discard_outputs(file_ob, file_ent, file_ext, ob_filename, ent_filename, ext_filename);
         free(ob_filename);
         free(ent_filename);
         free(ext_filename);
-        exit(EXIT_FAILURE);
+        *no_errors = FALSE;
+        return;
     }
 
     /* Perform the second pass operations */
-    preSecondPass(*labels, *IC);
-    check_alligal_extern_labels(labels, externList, no_errors, file_name);
-    check_alligal_entry_labels(labels, no_errors, file_name, entryList, file_ent);
-    check_if_label(*labels, *label_list_used, instructionArray, no_errors, file_name, *externList, file_ext, &is_extern);
-
-    /* Write instructions and data to .ob file */
-    fprintf(file_ob, "   %d  %d\n", *IC - 100, *DC);
-    printInstructionsInOctal(instructionArray, file_ob);
-    printDataAndCharData(head, headChar, IC, file_ob);
+    secondPassToStreams(file_name, IC, labels, externList, entryList, dataSegment, instructionArray, program, no_errors, file_ob, file_ent, file_ext, &is_extern);
 
-    /* Free allocated memory */
-    free_list(*label_list_used);
-    free_instruction_array(instructionArray);
-    freeLabels(*labels);
-    freeEntryList(*entryList);
-    freeExternList(externList);
-    freeDataList(*head);
-    freeCharDataList(*headChar);
-
-    /* Handle errors and clean up */
-    if (*no_errors == FALSE)
-    {
-        remove(ob_filename);
-        remove(ent_filename);
-        remove(ext_filename);
-    }
-    /*if there is no room in mommory*/
-    if (*IC > MAX_MOMMORY)
+    /* Handle errors and clean up, if there is no room in mommory nothing is kept either */
+    if (*no_errors == FALSE || *IC > MAX_MOMMORY)
     {
-        printError(ERROR_NOT_ENOUGH_MOMMORY, MAX_MOMMORY, file_name);
-        remove(ob_filename);
-        remove(ent_filename);
-        remove(ext_filename);
+        discard_outputs(file_ob, file_ent, file_ext, ob_filename, ent_filename, ext_filename);
     }
     else
     {
@@ -297,7 +380,16 @@ void secondPass(char *file_name, int* IC, int* DC, LabelNode** labels, ExternLis
         {
             remove(ext_filename);
         }
-        fclose(file_ob);
+
+        /* The end of the object may only reach the file when it is closed */
+        if (fclose(file_ob) != 0 && *no_errors)
+        {
+            fprintf(errorStream(), "Error writing .ob file: %s\n", ob_filename);
+            remove(ob_filename);
+            remove(ent_filename);
+            remove(ext_filename);
+            *no_errors = FALSE;
+        }
     }
 
     /* Free allocated memory */
@@ -305,68 +397,3 @@ void secondPass(char *file_name, int* IC, int* DC, LabelNode** labels, ExternLis
     free(ent_filename);
     free(ext_filename);
 }
-
-/* 
- * Prints the instructions in octal format to the specified file.
- * 
- */
-void printInstructionsInOctal(InstructionArray *instructionArray, FILE *file_ob) 
-{
-    int ic = 100;
-    int i;
-    for (i = 0; i < instructionArray->size; i++) 
-    {
-        unsigned int binaryValue = 0;
-        if (instructionArray->instructions[i].isRaw) 
-        {
-            /* Generate binary value for RawInstruction */
-            binaryValue = (instructionArray->instructions[i].instruction.raw.ARE) |
-                          (instructionArray->instructions[i].instruction.raw.num << 3);
-        } 
-        else if (instructionArray->instructions[i].isSimple) 
-        {
-            /* Generate binary value for SimpleInstruction */
-            binaryValue = (instructionArray->instructions[i].instruction.simple.ARE) |
-                          (instructionArray->instructions[i].instruction.simple.srcOperand << 6) |
-                          (instructionArray->instructions[i].instruction.simple.destOperand << 3);
-        } 
-        else 
-        {
-            /* Generate binary value for EncodedInstruction */
-            binaryValue = (instructionArray->instructions[i].instruction.detailed.ARE) |
-                          (instructionArray->instructions[i].instruction.detailed.srcOperand << 7) |
-                          (instructionArray->instructions[i].instruction.detailed.destOperand << 3) |
-                          (instructionArray->instructions[i].instruction.detailed.opcode << 11);
-        }
-
-        /* Print the value in octal format */
-        fprintf(file_ob, "%04d %05o\n", ic, binaryValue);  /* %05o ensures 5 octal digits, even if leading zeros */
-        ic++;
-    }
-}
-
-/* 
- * Prints data and character data values to the specified file.
- * 
- */
-void printDataAndCharData(Data** head, CharData** headChar, int* IC, FILE* file_ob) 
-{
-    Data* currentData = *head;
-    CharData* currentChar = *headChar;
-    while (currentData != NULL || currentChar != NULL) 
-    {
-        if (currentData != NULL && (currentChar == NULL || currentData->lineNumber <= currentChar->lineNumber)) 
-        {
-            fprintf(file_ob, "%04d %05o\n", *IC, currentData->numberValue);
-            currentData = currentData->next;
-            (*IC)++;
-        } 
-        else if (currentChar != NULL && (currentData == NULL || currentChar->lineNumber < currentData->lineNumber)) 
-        {
-            fprintf(file_ob, "%04d %05o\n", *IC, currentChar->asciiValue);
-            currentChar = currentChar->next;
-            (*IC)++;
-        }
-    }
-}
-
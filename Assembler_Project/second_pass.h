@@ -2,6 +2,11 @@
 #define SECOND_PAST_H
 #define MAX_MOMMORY 4096
 
+/* What a symbol refers to when it is not the address of a label defined in the file */
+#define SYMBOL_UNRESOLVED (-1) /* Not looked up yet */
+#define SYMBOL_EXTERNAL (-2)   /* Declared .extern */
+#define SYMBOL_UNDEFINED (-3)  /* Neither defined nor declared */
+
 #include <stdio.h>
 #include <ctype.h>
 #include <stdlib.h>
@@ -14,6 +19,8 @@
 #include "instructions.h"
 #include "pre_assembler.h"
 #include "util_instructions.h"
+#include "object_file.h"
+#include "ir.h"
 
 /**
  * Opens the files needed for the second pass of assembly.
@@ -26,26 +33,26 @@
 void openFiles(const char *file_name);
 
 /**
- * Performs the second pass of assembly on the provided label list and instruction count.
+ * Performs the second pass of assembly on the provided symbol table and instruction count.
  * 
- * This function processes the label list and instruction count to ensure that all labels
+ * This function processes the symbol table and instruction count to ensure that all labels
  * and instructions are correctly handled during the second pass of assembly.
  * 
- * @param head: A pointer to the head of the label list.
+ * @param labels: A pointer to the symbol table.
  * @param ic: The instruction count to be used during the second pass.
  */
-void preSecondPass(LabelNode *head, int ic);
+void preSecondPass(SymbolTable *labels, int ic);
 
 /**
- * Checks if a label name is valid and exists in the provided label list.
+ * Checks if a label name is valid and exists in the provided symbol table.
  * 
- * This function verifies whether a given label name is present in the label list.
+ * This function looks a given label name up in the symbol table.
  * 
- * @param labels: A pointer to the label list.
+ * @param labels: A pointer to the symbol table.
  * @param label_name: The name of the label to check.
- * @return: Returns 1 if the label name is found, 0 otherwise.
+ * @return: Returns the address of the label if it is found, 0 otherwise.
  */
-int check_label_name(LabelNode* labels, char* label_name);
+int check_label_name(SymbolTable* labels, char* label_name);
 
 /**
  * Checks for illegal extern labels and updates the error status.
@@ -53,12 +60,12 @@ int check_label_name(LabelNode* labels, char* label_name);
  * This function verifies if there are any illegal extern labels in the provided extern list.
  * It also updates the error status and outputs any relevant errors to the specified file.
  * 
- * @param labels: A pointer to the label list.
+ * @param labels: A pointer to the symbol table.
  * @param externList: A pointer to the list of extern labels.
  * @param no_errors: A pointer to a boolean flag indicating if there are no errors.
  * @param file_name: The name of the file where errors will be logged.
  */
-void check_alligal_extern_labels(LabelNode** labels, ExternList* externList, Bool* no_errors, char *file_name);
+void check_alligal_extern_labels(SymbolTable* labels, ExternList* externList, Bool* no_errors, char *file_name);
 
 /**
  * Checks if a label name is in the extern list.
@@ -77,75 +84,75 @@ Bool check_label_extern_name(ExternList* externList, char* label_name);
  * This function verifies if there are any illegal entry labels in the provided entry list.
  * It also updates the error status and outputs any relevant errors to the specified file.
  * 
- * @param labels: A pointer to the label list.
+ * @param labels: A pointer to the symbol table.
  * @param no_errors: A pointer to a boolean flag indicating if there are no errors.
  * @param file_name: The name of the file where errors will be logged.
  * @param entryList: A pointer to the list of entry labels.
  * @param file_ent: A file pointer where entry labels will be written.
  */
-void check_alligal_entry_labels(LabelNode** labels, Bool* no_errors, char *file_name, EntryList** entryList, FILE* file_ent);
+void check_alligal_entry_labels(SymbolTable* labels, Bool* no_errors, char *file_name, EntryList** entryList, FILE* file_ent);
 
 /**
- * Checks if labels are used correctly and updates error status.
+ * Encodes the instructions of the program into machine words and resolves their label operands.
  * 
- * This function verifies if the labels are used correctly in the provided label list
- * and instruction array. It also checks for extern labels and updates the error status.
+ * This function walks the statements parsed by the first pass and appends the words of every
+ * instruction to the instruction array. A label operand becomes the relocatable address of the
+ * label, or an external word that is written to the .ext file; an undefined label is reported.
+ * The label operands of instructions with errors are checked without encoding any words.
  * 
- * @param labels: A pointer to the label list.
- * @param label_list_used: A pointer to the list of labels that have been used.
- * @param instructionArray: A pointer to the array of instructions.
+ * @param labels: A pointer to the symbol table.
+ * @param program: A pointer to the statements of the file.
+ * @param instructionArray: A pointer to the array the words are appended to.
  * @param no_errors: A pointer to a boolean flag indicating if there are no errors.
  * @param file_name: The name of the file where errors will be logged.
  * @param externList: A pointer to the list of extern labels.
  * @param ext_file: A file pointer where extern labels will be written.
- * @param is_extern: A pointer to a boolean flag indicating if the label is extern.
+ * @param is_extern: A pointer to a boolean flag, set to FALSE when an extern label is used.
  */
-void check_if_label(LabelNode* labels, Node* label_list_used, InstructionArray* instructionArray, Bool* no_errors, char *file_name, ExternList externList, FILE* ext_file, Bool* is_extern);
+void encode_instructions(SymbolTable* labels, const Program* program, InstructionArray* instructionArray, Bool* no_errors, char *file_name, ExternList* externList, FILE* ext_file, Bool* is_extern);
 
 /**
- * Executes the second pass of assembly, processing labels, externs, and entries.
+ * Performs the second pass of assembly, writing the outputs to open streams.
  * 
- * This function performs the second pass of assembly on the provided data, processing
- * labels, externs, entries, and instructions. It also updates the instruction and data
- * counts and handles any errors encountered.
+ * This function runs the checks of the extern and entry labels, encodes the instructions,
+ * writes the object to file_ob, the entries to file_ent and the uses of extern labels to file_ext,
+ * and adds the data count to the instruction count. When the program does not fit in memory
+ * the error is reported, but removing or discarding the outputs is left to the caller.
  * 
- * @param file_name: The name of the file to process.
+ * @param file_name: The name of the file, used in the error messages.
  * @param IC: A pointer to the instruction count.
- * @param DC: A pointer to the data count.
- * @param labels: A pointer to the label list.
+ * @param labels: A pointer to the symbol table.
  * @param externList: A pointer to the list of extern labels.
  * @param entryList: A pointer to the list of entry labels.
- * @param head: A pointer to the head of the data list.
- * @param headChar: A pointer to the head of the character data list.
- * @param instructionArray: A pointer to the array of instructions.
- * @param label_list_used: A pointer to the list of labels that have been used.
+ * @param dataSegment: A pointer to the data segment (its size is the data count).
+ * @param instructionArray: A pointer to the array the instructions are encoded into.
+ * @param program: A pointer to the statements parsed by the first pass.
  * @param no_errors: A pointer to a boolean flag indicating if there are no errors.
+ * @param file_ob: The stream the object is written to.
+ * @param file_ent: The stream the entry labels are written to.
+ * @param file_ext: The stream the uses of extern labels are written to.
+ * @param is_extern: A pointer to a boolean flag, set to FALSE when an extern label is used.
  */
-void secondPass(char *file_name, int* IC, int* DC, LabelNode** labels, ExternList* externList, EntryList** entryList, Data** head, CharData** headChar, InstructionArray* instructionArray, Node** label_list_used, Bool* no_errors);
+void secondPassToStreams(char *file_name, int* IC, SymbolTable* labels, ExternList* externList, EntryList** entryList, DataSegment* dataSegment, InstructionArray* instructionArray, const Program* program, Bool* no_errors, FILE* file_ob, FILE* file_ent, FILE* file_ext, Bool* is_extern);
 
 /**
- * Prints the instructions in octal format to the specified file.
- * 
- * This function converts and prints the instructions in the instruction array to octal
- * format and writes them to the specified object file.
- * 
- * @param instructionArray: A pointer to the array of instructions.
- * @param file_ob: A file pointer to the object file where the instructions will be written.
- */
-void printInstructionsInOctal(InstructionArray *instructionArray, FILE* file_ob);
-
-/**
- * Prints the data and character data to the specified object file.
+ * Executes the second pass of assembly, processing labels, externs, and entries.
  * 
- * This function writes the data and character data to the specified object file,
- * including the instruction count and data count.
+ * This function performs the second pass of assembly on the provided data, processing
+ * labels, externs, entries, and instructions. It also updates the instruction and data
+ * counts and handles any errors encountered.
  * 
- * @param head: A pointer to the head of the data list.
- * @param headChar: A pointer to the head of the character data list.
+ * @param file_name: The name of the file to process.
  * @param IC: A pointer to the instruction count.
- * @param file_ob: A file pointer to the object file where the data will be written.
+ * @param labels: A pointer to the symbol table.
+ * @param externList: A pointer to the list of extern labels.
+ * @param entryList: A pointer to the list of entry labels.
+ * @param dataSegment: A pointer to the data segment (its size is the data count).
+ * @param instructionArray: A pointer to the array the instructions are encoded into.
+ * @param program: A pointer to the statements parsed by the first pass.
+ * @param no_errors: A pointer to a boolean flag indicating if there are no errors.
  */
-void printDataAndCharData(Data** head, CharData** headChar, int* IC, FILE* file_ob);
+void secondPass(char *file_name, int* IC, SymbolTable* labels, ExternList* externList, EntryList** entryList, DataSegment* dataSegment, InstructionArray* instructionArray, const Program* program, Bool* no_errors);
 
 #endif /* SECOND_PAST_H */
 
@@ -0,0 +1,744 @@
+#define _POSIX_C_SOURCE 200809L /* Unix domain sockets */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/un.h>
+
+#include "server.h"
+#include "source_file.h"
+#include "pre_assembler.h"
+#include "util_pre_assembler.h"
+
+#define RESPONSE_NUMBERS 4 /* Numbers at the start of a response: result, assembled, code_words, data_words */
+#define RESPONSE_FIELDS 5  /* Fields of a response: diagnostics, object, entries, externs, expanded */
+
+/*
+ * Structure to represent a growable buffer a worker keeps between requests.
+ * - data: The buffer, NUL-terminated after every field read into it.
+ * - capacity: The allocated size of the buffer.
+ */
+typedef struct {
+    char *data;
+    size_t capacity;
+} FieldBuffer;
+
+static const char *listening_path = NULL; /* The socket to remove when the server is stopped */
+static int listener = -1;                 /* The socket the dispatcher accepts connections on */
+static int wake_pipe[2] = { -1, -1 };     /* The workers write the connections they are done with here */
+
+/* The connections with a request to serve, taken by the workers in order */
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_ready = PTHREAD_COND_INITIALIZER;
+static int *ready = NULL;
+static int ready_count = 0;
+static int ready_capacity = 0;
+static Bool stopping = FALSE;
+
+/* Writes all the bytes of a buffer to a socket */
+static Bool write_full(int fd, const void *data, size_t length)
+{
+    const char *bytes = (const char *)data;
+    ssize_t count;
+
+    while (length > 0)
+    {
+        count = write(fd, bytes, length);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            return FALSE;
+        }
+        bytes += count;
+        length -= count;
+    }
+    return TRUE;
+}
+
+/* Reads exactly the given number of bytes from a socket, FALSE at the end of the connection */
+static Bool read_full(int fd, void *data, size_t length)
+{
+    char *bytes = (char *)data;
+    ssize_t count;
+
+    while (length > 0)
+    {
+        count = read(fd, bytes, length);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            return FALSE;
+        }
+        bytes += count;
+        length -= count;
+    }
+    return TRUE;
+}
+
+/* Writes a number as 4 bytes, most significant first */
+static Bool write_number(int fd, unsigned long number)
+{
+    unsigned char bytes[4];
+
+    bytes[0] = (unsigned char)(number >> 24);
+    bytes[1] = (unsigned char)(number >> 16);
+    bytes[2] = (unsigned char)(number >> 8);
+    bytes[3] = (unsigned char)number;
+    return write_full(fd, bytes, sizeof(bytes));
+}
+
+/* Reads a number of 4 bytes, most significant first */
+static Bool read_number(int fd, unsigned long *number)
+{
+    unsigned char bytes[4];
+
+    if (!read_full(fd, bytes, sizeof(bytes)))
+    {
+        return FALSE;
+    }
+    *number = ((unsigned long)bytes[0] << 24) | ((unsigned long)bytes[1] << 16) | ((unsigned long)bytes[2] << 8) | bytes[3];
+    return TRUE;
+}
+
+/* Writes a field, or a missing field when data is NULL */
+static Bool write_field(int fd, const char *data, size_t length)
+{
+    if (data == NULL)
+    {
+        return write_number(fd, SERVER_ABSENT_FIELD);
+    }
+    return write_number(fd, (unsigned long)length) && write_full(fd, data, length);
+}
+
+/* Reads a field into a buffer that grows as needed, FALSE for a missing or too long field */
+static Bool read_field_into(int fd, FieldBuffer *buffer, size_t *length)
+{
+    unsigned long field_length;
+    char *grown;
+
+    if (!read_number(fd, &field_length) || field_length > SERVER_MAX_FIELD)
+    {
+        return FALSE;
+    }
+    if (field_length + 1 > buffer->capacity)
+    {
+        grown = (char *)realloc(buffer->data, field_length + 1);
+        if (grown == NULL)
+        {
+            return FALSE;
+        }
+        buffer->data = grown;
+        buffer->capacity = field_length + 1;
+    }
+    if (!read_full(fd, buffer->data, field_length))
+    {
+        return FALSE;
+    }
+    buffer->data[field_length] = '\0';
+    *length = field_length;
+    return TRUE;
+}
+
+/* Reads a field into a new buffer allocated with malloc, which is NULL for a missing field */
+static Bool read_field(int fd, char **data, size_t *length)
+{
+    unsigned long field_length;
+
+    *data = NULL;
+    *length = 0;
+    if (!read_number(fd, &field_length))
+    {
+        return FALSE;
+    }
+    if (field_length == SERVER_ABSENT_FIELD)
+    {
+        return TRUE;
+    }
+    if (field_length > SERVER_MAX_FIELD || (*data = (char *)malloc(field_length + 1)) == NULL)
+    {
+        return FALSE;
+    }
+    if (!read_full(fd, *data, field_length))
+    {
+        free(*data);
+        *data = NULL;
+        return FALSE;
+    }
+    (*data)[field_length] = '\0';
+    *length = field_length;
+    return TRUE;
+}
+
+/*
+ * Serves one request of a connection. Returns FALSE when the client closed the connection, broke
+ * the protocol or stalled longer than SERVER_IO_TIMEOUT, so the connection must be closed.
+ */
+static Bool serve_request(int fd, asm_context *context, FieldBuffer *name, FieldBuffer *source)
+{
+    char magic[sizeof(SERVER_MAGIC) - 1];
+    unsigned long flags;
+    size_t name_length;
+    size_t source_length;
+    asm_result result;
+    int status;
+    Bool sent;
+
+    if (!read_full(fd, magic, sizeof(magic)) || memcmp(magic, SERVER_MAGIC, sizeof(magic)) != 0 ||
+        !read_number(fd, &flags) || !read_field_into(fd, name, &name_length) ||
+        !read_field_into(fd, source, &source_length))
+    {
+        return FALSE;
+    }
+
+    status = asm_assemble_with(context, name->data, source->data, source_length, (int)flags, &result);
+
+    sent = write_number(fd, (unsigned long)status) && write_number(fd, (unsigned long)result.assembled) &&
+           write_number(fd, (unsigned long)result.code_words) && write_number(fd, (unsigned long)result.data_words) &&
+           write_field(fd, result.diagnostics, result.diagnostics_length) &&
+           write_field(fd, result.object, result.object_length) &&
+           write_field(fd, result.entries, result.entries_length) &&
+           write_field(fd, result.externs, result.externs_length) &&
+           write_field(fd, result.expanded, result.expanded_length);
+    asm_result_free(&result);
+    return sent;
+}
+
+/*
+ * The main function of a worker thread: serves one request after the other, each from the
+ * connection at the head of the ready queue, with the same context. A connection that stays open
+ * goes back to the dispatcher to wait for its next request.
+ */
+static void *server_worker(void *arg)
+{
+    asm_context *context = asm_context_create();
+    FieldBuffer name = { NULL, 0 };
+    FieldBuffer source = { NULL, 0 };
+    int fd;
+
+    (void)arg;
+    if (context == NULL)
+    {
+        fprintf(stderr, "Unable to allocate memory for a server worker\n");
+        return NULL;
+    }
+    for (;;)
+    {
+        pthread_mutex_lock(&queue_lock);
+        while (ready_count == 0 && !stopping)
+        {
+            pthread_cond_wait(&queue_ready, &queue_lock);
+        }
+        if (stopping)
+        {
+            pthread_mutex_unlock(&queue_lock);
+            break;
+        }
+        fd = ready[0];
+        ready_count--;
+        memmove(ready, ready + 1, ready_count * sizeof(int));
+        pthread_mutex_unlock(&queue_lock);
+
+        if (serve_request(fd, context, &name, &source))
+        {
+            if (!write_full(wake_pipe[1], &fd, sizeof(fd)))
+            {
+                close(fd);
+            }
+        }
+        else
+        {
+            close(fd);
+        }
+    }
+    free(name.data);
+    free(source.data);
+    asm_context_free(context);
+    return NULL;
+}
+
+/* Removes the socket and ends the server on SIGINT or SIGTERM */
+static void stop_server(int signal_number)
+{
+    (void)signal_number;
+    if (listening_path != NULL)
+    {
+        unlink(listening_path);
+    }
+    _exit(0);
+}
+
+/* Fills the address of a socket, FALSE if the path does not fit */
+static Bool make_address(struct sockaddr_un *address, const char *socket_path)
+{
+    if (strlen(socket_path) >= sizeof(address->sun_path))
+    {
+        fprintf(stderr, "Error: the socket path is too long: %s\n", socket_path);
+        return FALSE;
+    }
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    strcpy(address->sun_path, socket_path);
+    return TRUE;
+}
+
+/* Connects to the socket of a server */
+int connect_server(const char *socket_path)
+{
+    struct sockaddr_un address;
+    int fd;
+
+    if (!make_address(&address, socket_path))
+    {
+        return -1;
+    }
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/*
+ * Creates the listening socket. A socket file left by a server that is no longer running is
+ * replaced, but a socket a server still answers on is not.
+ */
+static int listen_on(const char *socket_path)
+{
+    struct sockaddr_un address;
+    Bool bound;
+    int fd;
+    int other;
+
+    if (!make_address(&address, socket_path))
+    {
+        return -1;
+    }
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Error: cannot create the socket %s\n", socket_path);
+        return -1;
+    }
+    bound = bind(fd, (struct sockaddr *)&address, sizeof(address)) == 0 ? TRUE : FALSE;
+    if (!bound && errno == EADDRINUSE)
+    {
+        other = connect_server(socket_path);
+        if (other >= 0)
+        {
+            close(other);
+            fprintf(stderr, "Error: a server is already listening on %s\n", socket_path);
+            close(fd);
+            return -1;
+        }
+        unlink(socket_path);
+        bound = bind(fd, (struct sockaddr *)&address, sizeof(address)) == 0 ? TRUE : FALSE;
+    }
+    if (!bound || listen(fd, SOMAXCONN) != 0)
+    {
+        fprintf(stderr, "Error: cannot listen on the socket %s\n", socket_path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Adds a connection to the ready queue and wakes a worker, FALSE if the queue cannot grow */
+static Bool queue_connection(int fd)
+{
+    int *grown;
+    Bool queued = TRUE;
+
+    pthread_mutex_lock(&queue_lock);
+    if (ready_count == ready_capacity)
+    {
+        grown = (int *)realloc(ready, (ready_capacity == 0 ? 16 : ready_capacity * 2) * sizeof(int));
+        if (grown == NULL)
+        {
+            queued = FALSE;
+        }
+        else
+        {
+            ready = grown;
+            ready_capacity = ready_capacity == 0 ? 16 : ready_capacity * 2;
+        }
+    }
+    if (queued)
+    {
+        ready[ready_count++] = fd;
+        pthread_cond_signal(&queue_ready);
+    }
+    pthread_mutex_unlock(&queue_lock);
+    return queued;
+}
+
+/*
+ * Adds a descriptor to the set the dispatcher waits on, growing the set as needed.
+ * Returns FALSE if the set cannot grow.
+ */
+static Bool watch(struct pollfd **watched, int *count, int *capacity, int fd)
+{
+    struct pollfd *grown;
+
+    if (*count == *capacity)
+    {
+        grown = (struct pollfd *)realloc(*watched, *capacity * 2 * sizeof(struct pollfd));
+        if (grown == NULL)
+        {
+            return FALSE;
+        }
+        *watched = grown;
+        *capacity *= 2;
+    }
+    (*watched)[*count].fd = fd;
+    (*watched)[*count].events = POLLIN;
+    (*watched)[*count].revents = 0;
+    (*count)++;
+    return TRUE;
+}
+
+/*
+ * Accepts a new connection. A client that stalls in the middle of a request or of its response
+ * for SERVER_IO_TIMEOUT seconds is disconnected, so it cannot hold a worker.
+ */
+static int accept_connection(void)
+{
+    struct timeval timeout;
+    int fd = accept(listener, NULL, NULL);
+
+    if (fd >= 0)
+    {
+        timeout.tv_sec = SERVER_IO_TIMEOUT;
+        timeout.tv_usec = 0;
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    }
+    return fd;
+}
+
+/*
+ * The dispatcher: waits on the listening socket, on the idle connections and on the connections
+ * the workers give back, and queues every connection with a request for the workers. An idle
+ * connection holds no worker, so any number of clients can stay connected between requests.
+ * Returns only if waiting fails.
+ */
+static void dispatch_connections(void)
+{
+    struct pollfd *watched;
+    int count = 2;
+    int capacity = 16;
+    int fd;
+    int i;
+
+    watched = (struct pollfd *)malloc(capacity * sizeof(struct pollfd));
+    if (watched == NULL)
+    {
+        fprintf(stderr, "Unable to allocate memory for the server connections\n");
+        return;
+    }
+    watched[0].fd = listener;
+    watched[0].events = POLLIN;
+    watched[1].fd = wake_pipe[0];
+    watched[1].events = POLLIN;
+
+    for (;;)
+    {
+        if (poll(watched, count, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        /* Connections with a request go to the workers and are not watched until they come back */
+        for (i = 2; i < count; i++)
+        {
+            if (watched[i].revents != 0)
+            {
+                if (!queue_connection(watched[i].fd))
+                {
+                    close(watched[i].fd);
+                }
+                watched[i--] = watched[--count];
+            }
+        }
+        if (watched[1].revents & POLLIN)
+        {
+            if (read_full(wake_pipe[0], &fd, sizeof(fd)) && !watch(&watched, &count, &capacity, fd))
+            {
+                close(fd);
+            }
+        }
+        if (watched[0].revents & POLLIN)
+        {
+            fd = accept_connection();
+            if (fd >= 0 && !watch(&watched, &count, &capacity, fd))
+            {
+                close(fd);
+            }
+        }
+    }
+    fprintf(stderr, "Error: the server cannot wait for its connections\n");
+    free(watched);
+}
+
+/*
+ * Starts the worker threads and dispatches the requests of the clients to them; they run until
+ * the server is stopped by a signal.
+ */
+int run_server(const char *socket_path, int workers)
+{
+    pthread_t *threads;
+    int started = 0;
+    int i;
+
+    listener = listen_on(socket_path);
+    if (listener < 0)
+    {
+        return 1;
+    }
+    listening_path = socket_path;
+    signal(SIGINT, stop_server);
+    signal(SIGTERM, stop_server);
+
+    /* A client that goes away while its response is written must not end the server */
+    signal(SIGPIPE, SIG_IGN);
+
+    /* A client that connects and leaves before it is accepted must not block the dispatcher */
+    fcntl(listener, F_SETFL, fcntl(listener, F_GETFL) | O_NONBLOCK);
+
+    threads = (pthread_t *)malloc(workers * sizeof(pthread_t));
+    if (threads == NULL || pipe(wake_pipe) != 0)
+    {
+        fprintf(stderr, "Unable to allocate memory for the server workers\n");
+        stop_server(0);
+    }
+    for (i = 0; i < workers; i++)
+    {
+        if (pthread_create(&threads[started], NULL, server_worker, NULL) == 0)
+        {
+            started++;
+        }
+    }
+    if (started > 0)
+    {
+        dispatch_connections();
+    }
+
+    pthread_mutex_lock(&queue_lock);
+    stopping = TRUE;
+    pthread_cond_broadcast(&queue_ready);
+    pthread_mutex_unlock(&queue_lock);
+    for (i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    free(ready);
+    close(wake_pipe[0]);
+    close(wake_pipe[1]);
+    close(listener);
+    unlink(socket_path);
+    asm_release_caches();
+    return 1;
+}
+
+/* Sends a request and reads the response into a result */
+Bool request_assembly(int fd, const char *name, const char *src, size_t len, int flags, asm_result *out, int *status)
+{
+    unsigned long numbers[RESPONSE_NUMBERS];
+    char **fields[RESPONSE_FIELDS];
+    size_t *lengths[RESPONSE_FIELDS];
+    int i;
+
+    out->object = out->entries = out->externs = out->diagnostics = out->expanded = NULL;
+    out->object_length = out->entries_length = out->externs_length = out->diagnostics_length = out->expanded_length = 0;
+    out->assembled = out->code_words = out->data_words = 0;
+
+    if (!write_full(fd, SERVER_MAGIC, sizeof(SERVER_MAGIC) - 1) || !write_number(fd, (unsigned long)flags) ||
+        !write_field(fd, name, strlen(name)) || !write_field(fd, src, len))
+    {
+        return FALSE;
+    }
+    for (i = 0; i < RESPONSE_NUMBERS; i++)
+    {
+        if (!read_number(fd, &numbers[i]))
+        {
+            return FALSE;
+        }
+    }
+    *status = (int)numbers[0];
+    out->assembled = (int)numbers[1];
+    out->code_words = (int)numbers[2];
+    out->data_words = (int)numbers[3];
+
+    fields[0] = &out->diagnostics;
+    lengths[0] = &out->diagnostics_length;
+    fields[1] = &out->object;
+    lengths[1] = &out->object_length;
+    fields[2] = &out->entries;
+    lengths[2] = &out->entries_length;
+    fields[3] = &out->externs;
+    lengths[3] = &out->externs_length;
+    fields[4] = &out->expanded;
+    lengths[4] = &out->expanded_length;
+    for (i = 0; i < RESPONSE_FIELDS; i++)
+    {
+        if (!read_field(fd, fields[i], lengths[i]))
+        {
+            asm_result_free(out);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*
+ * Writes one output of a file, or removes the file when the source does not have that output.
+ * Returns FALSE, after reporting it like the second pass, when the file cannot be written.
+ */
+static Bool write_output(const char *file_name, const char *extension, const char *data, size_t length)
+{
+    size_t path_length = strlen(file_name) + strlen(extension) + 1;
+    char *path = (char *)malloc(path_length);
+    Bool written = TRUE;
+    FILE *file;
+
+    if (path == NULL)
+    {
+        fprintf(stderr, "Unable to allocate memory for file names\n");
+        return FALSE;
+    }
+    my_snprintf(path, path_length, "%s%s", file_name, extension);
+    if (data == NULL)
+    {
+        remove(path);
+    }
+    else
+    {
+        file = fopen(path, "w");
+        if (file == NULL)
+        {
+            fprintf(stderr, "Error opening %s file: %s\n", extension, path);
+            written = FALSE;
+        }
+        else
+        {
+            written = fwrite(data, 1, length, file) == length ? TRUE : FALSE;
+            if (fclose(file) != 0)
+            {
+                written = FALSE;
+            }
+            if (!written)
+            {
+                fprintf(stderr, "Error writing %s file: %s\n", extension, path);
+                remove(path);
+            }
+        }
+    }
+    free(path);
+    return written;
+}
+
+/*
+ * Reads every file here and assembles it on the server, writing its outputs and printing its
+ * errors in the order of the files.
+ */
+int assemble_files_remote(const char *socket_path, char **files, int count, const AssemblerOptions *options)
+{
+    SourceFile input;
+    asm_result result;
+    char *input_file_name;
+    size_t length;
+    Bool answered;
+    int status;
+    int fd;
+    int i;
+
+    fd = connect_server(socket_path);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Error: cannot connect to the server at %s\n", socket_path);
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    for (i = 0; i < count; i++)
+    {
+        length = strlen(files[i]) + END_OF_FILE + 1;
+        input_file_name = (char *)malloc(length);
+        if (input_file_name == NULL)
+        {
+            fprintf(stderr, "Unable to allocate memory for file names\n");
+            exit(EXIT_FAILURE);
+        }
+        my_snprintf(input_file_name, length, "%s%s", files[i], ".as");
+        if (!open_source_file(&input, input_file_name))
+        {
+            fprintf(stderr, "Error opening input file: %s\n", input_file_name);
+            fprintf(stderr, "Failed to process file: %s\n", files[i]);
+            free(input_file_name);
+            continue;
+        }
+        free(input_file_name);
+
+        answered = request_assembly(fd, files[i], input.data, input.size, options->emit_am ? ASM_EMIT_EXPANDED : 0,
+                                    &result, &status);
+        close_source_file(&input);
+        if (!answered)
+        {
+            fprintf(stderr, "Error: the server at %s did not answer\n", socket_path);
+            close(fd);
+            return 1;
+        }
+        if (status == ASM_SYSTEM_ERROR)
+        {
+            fprintf(stderr, "Error: the server at %s ran out of memory\n", socket_path);
+            fprintf(stderr, "Failed to process file: %s\n", files[i]);
+            asm_result_free(&result);
+            continue;
+        }
+
+        /* The outputs are written and removed like the assembler does */
+        if (result.diagnostics != NULL)
+        {
+            fwrite(result.diagnostics, 1, result.diagnostics_length, stderr);
+        }
+        if (result.expanded != NULL)
+        {
+            write_output(files[i], ".am", result.expanded, result.expanded_length);
+        }
+        if (result.assembled &&
+            !(write_output(files[i], ".ob", result.object, result.object_length) &&
+              write_output(files[i], ".ent", result.entries, result.entries_length) &&
+              write_output(files[i], ".ext", result.externs, result.externs_length)))
+        {
+            /* A file whose outputs cannot all be written keeps none of them */
+            write_output(files[i], ".ob", NULL, 0);
+            write_output(files[i], ".ent", NULL, 0);
+            write_output(files[i], ".ext", NULL, 0);
+        }
+        asm_result_free(&result);
+    }
+    close(fd);
+    return 0;
+}
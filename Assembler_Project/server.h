@@ -0,0 +1,76 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "general_functions.h"
+#include "asm_library.h"
+
+#define DEFAULT_SERVER_WORKERS 4 /* Number of worker threads of a server started without -j */
+
+/*
+ * The protocol between the client and the server, over a Unix domain stream socket.
+ * Every number is 4 bytes, most significant first, and every field is a number with its
+ * length followed by its bytes; the length SERVER_ABSENT_FIELD stands for a missing field.
+ * A connection carries any number of requests, each answered before the next one is read:
+ * - request: the 4 bytes SERVER_MAGIC, the flags of asm_assemble_with, the name of the
+ *   source and its text;
+ * - response: the result of asm_assemble_with, assembled, code_words and data_words,
+ *   then the diagnostics, object, entries, externs and expanded source.
+ */
+#define SERVER_MAGIC "ASM1"
+#define SERVER_ABSENT_FIELD 0xFFFFFFFFUL
+#define SERVER_MAX_FIELD (256UL * 1024 * 1024) /* Longest field accepted, longer ones close the connection */
+#define SERVER_IO_TIMEOUT 10 /* Seconds a client may stall inside a request or its response before it is disconnected */
+
+/*
+ * Runs the assembler as a server listening on a Unix domain socket, until it is stopped by
+ * SIGINT or SIGTERM, which remove the socket. The main thread waits on all the connections and
+ * hands each request to a worker thread, so idle clients hold no worker. Every worker has its own
+ * context, so its memory and the tables of the process stay warm between requests. The macro
+ * definitions are cached across the sources of all the clients for the life of the server, up to
+ * DEFINITION_CACHE_MAX_BYTES.
+ *
+ * @param socket_path: The path of the socket to create.
+ * @param workers: The number of worker threads.
+ * @return: The exit status of the program, 1 if the socket cannot be created.
+ */
+int run_server(const char *socket_path, int workers);
+
+/*
+ * Assembles files on a server: each <name>.as file is read here and sent to the server, and the
+ * outputs and errors it answers with are written and printed as the assembler would.
+ *
+ * @param socket_path: The path of the socket of the server.
+ * @param files: The base names of the files to assemble.
+ * @param count: The number of files.
+ * @param options: The options that apply to every file; only emit_am is supported.
+ * @return: The exit status of the program, 1 if the server cannot be reached.
+ */
+int assemble_files_remote(const char *socket_path, char **files, int count, const AssemblerOptions *options);
+
+/*
+ * Connects to a server.
+ *
+ * @param socket_path: The path of the socket of the server.
+ * @return: The connected socket, or -1 if the server cannot be reached.
+ */
+int connect_server(const char *socket_path);
+
+/*
+ * Sends a request to a server and reads its response.
+ *
+ * @param fd: The connected socket.
+ * @param name: The name of the source.
+ * @param src: The text of the source.
+ * @param len: The number of characters of the source.
+ * @param flags: The flags of asm_assemble_with.
+ * @param out: The result to fill; release it with asm_result_free.
+ * @param status: Set to what asm_assemble_with returned on the server.
+ * @return: TRUE if the server answered, FALSE if the connection failed.
+ */
+Bool request_assembly(int fd, const char *name, const char *src, size_t len, int flags, asm_result *out, int *status);
+
+#endif /* SERVER_H */
@@ -0,0 +1,149 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "source_file.h"
+
+#define SOURCE_READ_CHUNK 65536 /* Number of bytes read at a time from a file that cannot be mapped */
+
+/* 
+ * Reads the whole of an open file descriptor into a growing buffer.
+ * Used for files that cannot be mapped.
+ */
+static Bool read_whole_file(SourceFile *file, int fd)
+{
+    size_t capacity = SOURCE_READ_CHUNK;
+    char *data = malloc(capacity);
+    char *grown;
+    ssize_t count;
+
+    file->size = 0;
+    while (data != NULL)
+    {
+        if (file->size == capacity)
+        {
+            capacity *= 2;
+            grown = realloc(data, capacity);
+            if (grown == NULL)
+            {
+                break;
+            }
+            data = grown;
+        }
+        count = read(fd, data + file->size, capacity - file->size);
+        if (count <= 0)
+        {
+            file->data = data;
+            return count == 0 ? TRUE : FALSE;
+        }
+        file->size += count;
+    }
+    free(data);
+    file->data = NULL;
+    return FALSE;
+}
+
+/* 
+ * Opens a source file, mapping it into memory when it is a non-empty regular file.
+ */
+Bool open_source_file(SourceFile *file, const char *path)
+{
+    struct stat info;
+    int fd = open(path, O_RDONLY);
+    void *mapping = MAP_FAILED;
+    Bool opened = TRUE;
+
+    file->borrowed = FALSE;
+    if (fd < 0)
+    {
+        return FALSE;
+    }
+
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+    {
+        mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    if (mapping != MAP_FAILED)
+    {
+        file->data = mapping;
+        file->size = info.st_size;
+        file->mapped = TRUE;
+    }
+    else
+    {
+        opened = read_whole_file(file, fd);
+        file->mapped = FALSE;
+    }
+    close(fd);
+
+    file->cursor = file->data;
+    if (!opened)
+    {
+        close_source_file(file);
+    }
+    return opened;
+}
+
+/* 
+ * Opens a source held by the caller, reading it in place.
+ */
+void open_source_buffer(SourceFile *file, const char *data, size_t size)
+{
+    file->data = (char *)data;
+    file->size = size;
+    file->cursor = data;
+    file->mapped = FALSE;
+    file->borrowed = TRUE;
+}
+
+/* 
+ * Finds the end of the next line with memchr and hands out a view of it.
+ */
+Bool next_source_line(SourceFile *file, SourceLine *line)
+{
+    const char *end = file->data + file->size;
+    const char *newline;
+
+    if (file->cursor == NULL || file->cursor >= end)
+    {
+        return FALSE;
+    }
+
+    newline = memchr(file->cursor, '\n', end - file->cursor);
+    line->start = file->cursor;
+    if (newline != NULL)
+    {
+        line->length = newline - file->cursor;
+        line->has_newline = TRUE;
+        file->cursor = newline + 1;
+    }
+    else
+    {
+        line->length = end - file->cursor;
+        line->has_newline = FALSE;
+        file->cursor = end;
+    }
+    return TRUE;
+}
+
+/* 
+ * Unmaps or frees the contents of a source file.
+ */
+void close_source_file(SourceFile *file)
+{
+    if (file->mapped)
+    {
+        munmap(file->data, file->size);
+    }
+    else if (!file->borrowed)
+    {
+        free(file->data);
+    }
+    file->data = NULL;
+    file->size = 0;
+    file->cursor = NULL;
+    file->mapped = FALSE;
+    file->borrowed = FALSE;
+}
@@ -0,0 +1,76 @@
+#ifndef SOURCE_FILE_H
+#define SOURCE_FILE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "general_functions.h"
+
+/* 
+ * Structure to represent a view of one line of a source file. The view points into the
+ * contents of the file and is not NUL-terminated.
+ * - start: Pointer to the first character of the line.
+ * - length: The number of characters in the line, without the newline.
+ * - has_newline: TRUE if the line ends with a newline (only the last line may not).
+ */
+typedef struct {
+    const char *start;
+    size_t length;
+    Bool has_newline;
+} SourceLine;
+
+/* 
+ * Structure to represent a source file opened for reading line by line.
+ * - data: The contents of the file.
+ * - size: The number of characters in the file.
+ * - cursor: Pointer to the start of the next line.
+ * - mapped: TRUE if the contents are mapped into memory, FALSE if they were read into a buffer.
+ * - borrowed: TRUE if the contents belong to the caller, which keeps them until the file is closed.
+ */
+typedef struct {
+    char *data;
+    size_t size;
+    const char *cursor;
+    Bool mapped;
+    Bool borrowed;
+} SourceFile;
+
+/* 
+ * Opens a source file. A regular file is mapped into memory; anything that cannot be
+ * mapped (such as a pipe) is read into a buffer instead.
+ * 
+ * @param file: Pointer to the source file to open.
+ * @param path: The path of the file.
+ * @return: TRUE if the file was opened, FALSE otherwise.
+ */
+Bool open_source_file(SourceFile *file, const char *path);
+
+/* 
+ * Opens a source that is already in memory. The contents are read in place, not copied,
+ * so they must stay valid until the source is closed.
+ * 
+ * @param file: Pointer to the source file to open.
+ * @param data: The contents of the source.
+ * @param size: The number of characters in the source.
+ */
+void open_source_buffer(SourceFile *file, const char *data, size_t size);
+
+/* 
+ * Hands out a view of the next line of a source file, without copying it.
+ * 
+ * @param file: Pointer to the source file.
+ * @param line: Pointer to the view to fill.
+ * @return: TRUE if a line was read, FALSE at the end of the file.
+ */
+Bool next_source_line(SourceFile *file, SourceLine *line);
+
+/* 
+ * Closes a source file and releases its contents, unless they were borrowed from the caller.
+ * The views of its lines become invalid.
+ * 
+ * @param file: Pointer to the source file to close.
+ */
+void close_source_file(SourceFile *file);
+
+#endif /* SOURCE_FILE_H */
@@ -0,0 +1,97 @@
+#define _POSIX_C_SOURCE 199309L /* clock_gettime */
+
+#include <time.h>
+
+#include "stats.h"
+
+#define STATS_LINE_MAX 512 /* Room for a line of statistics, without the file name */
+
+/* Function to initialize the statistics of a file to zero */
+void init_file_stats(FileStats *stats)
+{
+    memset(stats, 0, sizeof(FileStats));
+    stats->cached = FALSE;
+}
+
+/* Function to read a monotonic clock in seconds */
+double stats_clock(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/* 
+ * Function to copy a file name into a JSON string, escaping the quotes, the backslashes and
+ * the control characters. Returns the number of characters written, without the NUL.
+ */
+static size_t escape_json(char *out, const char *text)
+{
+    static const char hex[] = "0123456789abcdef";
+    size_t length = 0;
+    unsigned char c;
+
+    for (; *text != '\0'; text++)
+    {
+        c = (unsigned char)*text;
+        if (c == '"' || c == '\\')
+        {
+            out[length++] = '\\';
+            out[length++] = (char)c;
+        }
+        else if (c < 0x20)
+        {
+            memcpy(out + length, "\\u00", 4);
+            out[length + 4] = hex[c >> 4];
+            out[length + 5] = hex[c & 15];
+            length += 6;
+        }
+        else
+        {
+            out[length++] = (char)c;
+        }
+    }
+    out[length] = '\0';
+    return length;
+}
+
+/* Function to write the statistics of a file as one line of text or JSON */
+void print_file_stats(FILE *stream, const char *file_name, const FileStats *stats, StatsFormat format)
+{
+    /* An escaped character takes at most 6 characters */
+    char *line = malloc(strlen(file_name) * 6 + STATS_LINE_MAX);
+    size_t length;
+
+    if (line == NULL)
+    {
+        fprintf(stderr, "Unable to allocate memory for the statistics\n");
+        return;
+    }
+
+    if (format == STATS_JSON)
+    {
+        strcpy(line, "{\"file\":\"");
+        length = strlen(line);
+        length += escape_json(line + length, file_name);
+        sprintf(line + length,
+                "\",\"cached\":%s,\"pre_assembly_ms\":%.3f,\"first_pass_ms\":%.3f,\"second_pass_ms\":%.3f,"
+                "\"lines_read\":%ld,\"macros_expanded\":%ld,\"labels_defined\":%ld,\"references_patched\":%ld,"
+                "\"words_emitted\":%ld,\"bytes_allocated\":%lu}\n",
+                stats->cached ? "true" : "false", stats->pre_assembly * 1e3, stats->first_pass * 1e3,
+                stats->second_pass * 1e3, stats->lines_read, stats->macros_expanded, stats->labels_defined,
+                stats->references_patched, stats->words_emitted, (unsigned long)stats->bytes_allocated);
+    }
+    else
+    {
+        sprintf(line,
+                "%s:%s pre-assembly %.3f ms, first pass %.3f ms, second pass %.3f ms; %ld lines read, "
+                "%ld macros expanded, %ld labels defined, %ld references patched, %ld words emitted, "
+                "%lu bytes allocated\n",
+                file_name, stats->cached ? " (cached)" : "", stats->pre_assembly * 1e3, stats->first_pass * 1e3,
+                stats->second_pass * 1e3, stats->lines_read, stats->macros_expanded, stats->labels_defined,
+                stats->references_patched, stats->words_emitted, (unsigned long)stats->bytes_allocated);
+    }
+    fputs(line, stream);
+    free(line);
+}
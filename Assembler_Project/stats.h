@@ -0,0 +1,60 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "general_functions.h"
+
+/* 
+ * Structure to represent the statistics of the assembly of one file.
+ * - cached: TRUE if the outputs were restored from the output cache, so no stage ran.
+ * - pre_assembly: Wall time of the macro expansion, in seconds.
+ * - first_pass: Wall time of the first pass, in seconds.
+ * - second_pass: Wall time of the second pass, including writing the output files, in seconds.
+ * - lines_read: The number of lines read from the source file.
+ * - macros_expanded: The number of macro calls replaced with the lines of the macro.
+ * - labels_defined: The number of labels in the symbol table.
+ * - references_patched: The number of label operands the second pass resolves.
+ * - words_emitted: The number of words in the code and data images.
+ * - bytes_allocated: The number of bytes the arena of the file handed out.
+ */
+typedef struct {
+    Bool cached;
+    double pre_assembly;
+    double first_pass;
+    double second_pass;
+    long lines_read;
+    long macros_expanded;
+    long labels_defined;
+    long references_patched;
+    long words_emitted;
+    size_t bytes_allocated;
+} FileStats;
+
+/* 
+ * Initializes the statistics of a file to zero.
+ * 
+ * @param stats: Pointer to the statistics to initialize.
+ */
+void init_file_stats(FileStats *stats);
+
+/* 
+ * Reads a monotonic clock, for timing the stages.
+ * 
+ * @return: The time in seconds since an arbitrary point.
+ */
+double stats_clock(void);
+
+/* 
+ * Writes the statistics of a file as one line, in a single write so lines from several files do not mix.
+ * 
+ * @param stream: The stream to write to.
+ * @param file_name: The base name of the file (without extension).
+ * @param stats: The statistics of the file.
+ * @param format: STATS_TEXT for human readable text, STATS_JSON for a JSON object.
+ */
+void print_file_stats(FILE *stream, const char *file_name, const FileStats *stats, StatsFormat format);
+
+#endif /* STATS_H */
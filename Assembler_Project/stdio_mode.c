@@ -0,0 +1,146 @@
+#include "stdio_mode.h"
+#include "source_file.h"
+#include "pre_assembler.h"
+#include "util_pre_assembler.h"
+
+#define STDIN_CHUNK 65536 /* Initial size of the buffer the standard input is read into, doubled when full */
+
+/*
+ * Reads the whole standard input into a buffer allocated with malloc.
+ * Returns FALSE, with nothing allocated, if the buffer cannot be allocated or the input cannot be read.
+ */
+static Bool read_standard_input(char **data, size_t *size)
+{
+    size_t capacity = STDIN_CHUNK;
+    size_t length = 0;
+    char *buffer = (char *)malloc(capacity);
+    char *grown;
+
+    while (buffer != NULL)
+    {
+        length += fread(buffer + length, 1, capacity - length, stdin);
+        if (length < capacity)
+        {
+            break;
+        }
+        capacity *= 2;
+        grown = (char *)realloc(buffer, capacity);
+        if (grown == NULL)
+        {
+            free(buffer);
+        }
+        buffer = grown;
+    }
+    if (buffer == NULL || ferror(stdin))
+    {
+        free(buffer);
+        return FALSE;
+    }
+    *data = buffer;
+    *size = length;
+    return TRUE;
+}
+
+/* Writes one output of a file as a section, if the file has that output */
+static void write_section(const char *name, const char *extension, const char *data, size_t length)
+{
+    if (data != NULL)
+    {
+        printf("%s %s%s %lu\n", SECTION_MARKER, name, extension, (unsigned long)length);
+        fwrite(data, 1, length, stdout);
+    }
+}
+
+/* Writes the outputs of a file to stdout in the requested format */
+static void write_outputs(const char *name, const asm_result *result, StdoutFormat format)
+{
+    if (format == STDOUT_SECTIONS)
+    {
+        write_section(name, ".am", result->expanded, result->expanded_length);
+        write_section(name, ".ob", result->object, result->object_length);
+        write_section(name, ".ent", result->entries, result->entries_length);
+        write_section(name, ".ext", result->externs, result->externs_length);
+    }
+    else if (result->object != NULL)
+    {
+        fwrite(result->object, 1, result->object_length, stdout);
+    }
+}
+
+/*
+ * Assembles every file from memory, reading it from its .as file or from the standard input,
+ * and writes its outputs to stdout and its errors to stderr in the order of the files.
+ * The files share one context, so the memory of one source is reused by the next.
+ */
+int assemble_files_to_stdout(char **files, int count, const AssemblerOptions *options)
+{
+    asm_context *context = asm_context_create();
+    asm_result result;
+    SourceFile input;
+    const char *name;
+    char *input_file_name;
+    char *data = NULL;
+    size_t size;
+    size_t length;
+    int status;
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (strcmp(files[i], STDIN_ARGUMENT) == 0)
+        {
+            name = STDIN_SOURCE_NAME;
+            if (!read_standard_input(&data, &size))
+            {
+                fprintf(stderr, "Error opening input file: %s\n", STDIN_SOURCE_NAME);
+                fprintf(stderr, "Failed to process file: %s\n", name);
+                continue;
+            }
+            status = asm_assemble_with(context, name, data, size, options->emit_am ? ASM_EMIT_EXPANDED : 0, &result);
+            free(data);
+        }
+        else
+        {
+            name = files[i];
+            length = strlen(files[i]) + END_OF_FILE + 1;
+            input_file_name = (char *)malloc(length);
+            if (input_file_name == NULL)
+            {
+                fprintf(stderr, "Unable to allocate memory for file names\n");
+                exit(EXIT_FAILURE);
+            }
+            my_snprintf(input_file_name, length, "%s%s", files[i], ".as");
+            if (!open_source_file(&input, input_file_name))
+            {
+                fprintf(stderr, "Error opening input file: %s\n", input_file_name);
+                fprintf(stderr, "Failed to process file: %s\n", name);
+                free(input_file_name);
+                continue;
+            }
+            free(input_file_name);
+            status = asm_assemble_with(context, name, input.data, input.size, options->emit_am ? ASM_EMIT_EXPANDED : 0, &result);
+            close_source_file(&input);
+        }
+
+        if (status == ASM_SYSTEM_ERROR)
+        {
+            fprintf(stderr, "Failed to process file: %s\n", name);
+            continue;
+        }
+        fwrite(result.diagnostics, 1, result.diagnostics_length, stderr);
+        write_outputs(name, &result, options->to_stdout);
+        asm_result_free(&result);
+    }
+
+    if (context != NULL)
+    {
+        asm_context_free(context);
+    }
+    free_definition_cache();
+    if (fflush(stdout) != 0 || ferror(stdout))
+    {
+        fprintf(stderr, "Error: cannot write to stdout\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+#ifndef STDIO_MODE_H
+#define STDIO_MODE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "general_functions.h"
+#include "asm_library.h"
+
+#define STDIN_ARGUMENT "-"        /* The file argument that stands for the standard input */
+#define STDIN_SOURCE_NAME "stdin" /* The name the errors and sections of the standard input refer to */
+#define SECTION_MARKER "==="      /* Start of the header line of a section */
+
+/*
+ * With --stdout=sections, every output of a file is written as a section: a header line made of
+ * SECTION_MARKER, the name of the output (the base name of the file with .am, .ob, .ent or .ext)
+ * and the number of bytes that follow, then exactly those bytes. A file has the sections of the
+ * files the assembler would write for it, in that order, and none when it has errors.
+ * For example:
+ *
+ *     === prog.ob 24
+ *       <24 bytes of the object>
+ *     === prog.ext 11
+ *       <11 bytes of the externs>
+ */
+
+/*
+ * Assembles files one after the other with their outputs written to stdout instead of files,
+ * in the format of options->to_stdout. The file STDIN_ARGUMENT is read from the standard input.
+ * The errors are printed to stderr as the assembler prints them.
+ *
+ * @param files: The base names of the files to assemble, or STDIN_ARGUMENT.
+ * @param count: The number of files.
+ * @param options: The options that apply to every file; only emit_am and to_stdout are supported.
+ * @return: The exit status of the program, 1 if stdout cannot be written.
+ */
+int assemble_files_to_stdout(char **files, int count, const AssemblerOptions *options);
+
+#endif /* STDIO_MODE_H */
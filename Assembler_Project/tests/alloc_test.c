@@ -0,0 +1,149 @@
+/*
+ * Test that the first pass allocates nothing per line.
+ * The program is linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc, so every allocation
+ * of the assembler goes through the counters below. For every given source file:
+ * - tokenizeLine is run on every line of the expanded source, which must not allocate at all;
+ * - firstPass is run on the expanded source, and every allocation it makes must be a new block of
+ *   the arena of the file, whose blocks hold thousands of lines each.
+ * Prints the counts of every file and exits with a failure if either check does not hold.
+ *
+ * Usage: alloc_test file...  (the file names are given without the .as extension)
+ */
+#include "../general_functions.h"
+#include "../pre_assembler.h"
+#include "../first_pass.h"
+#include "../util_pre_assembler.h"
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *memory, size_t size);
+
+static long allocations = 0; /* Number of calls to malloc, calloc and realloc so far */
+
+void *__wrap_malloc(size_t size)
+{
+    allocations++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    allocations++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *memory, size_t size)
+{
+    allocations++;
+    return __real_realloc(memory, size);
+}
+
+/* Counts the blocks of an arena */
+static long count_blocks(const Arena *arena)
+{
+    const ArenaBlock *block;
+    long blocks = 0;
+
+    for (block = arena->blocks; block != NULL; block = block->next)
+    {
+        blocks++;
+    }
+    return blocks;
+}
+
+/*
+ * Expands the macros of a file, then counts the allocations of tokenizing its lines and of its
+ * first pass. Returns FALSE if the file cannot be read or a check fails.
+ */
+static Bool check_file(char *file_name)
+{
+    SymbolTable labels;
+    ExternList externList;
+    EntryList entryList;
+    DataSegment dataSegment;
+    Program program;
+    ExpandedSource source;
+    SourceFile input;
+    TokenList tokens;
+    Arena arena;
+    char path[FILENAME_MAX];
+    char line[MAX_LINE_LENGTH + 2];
+    const char *cursor;
+    long lines = 0;
+    long tokenize_allocations;
+    long pass_allocations;
+    long new_blocks;
+    int IC = 100;
+    Bool passed;
+
+    if (strlen(file_name) + END_OF_FILE + 1 > sizeof(path))
+    {
+        return FALSE;
+    }
+    my_snprintf(path, sizeof(path), "%s%s", file_name, ".as");
+    arena_init(&arena);
+    if (!open_source_file(&input, path))
+    {
+        fprintf(stderr, "Error opening input file: %s\n", path);
+        return FALSE;
+    }
+    initSymbolTable(&labels, &arena);
+    initEntryList(&entryList, &arena);
+    initExternList(&externList, &arena);
+    init_program(&program, &labels, &arena);
+    initDataSegment(&dataSegment, &arena);
+    init_expanded_source(&source, &arena);
+    if (!macro_file(file_name, &input, &arena, &source, FALSE))
+    {
+        fprintf(stderr, "Failed to process file: %s\n", file_name);
+        close_source_file(&input);
+        arena_free(&arena);
+        return FALSE;
+    }
+
+    /* Tokenizing works on views into the line */
+    tokenize_allocations = allocations;
+    cursor = source.text;
+    while (readSourceLine(&cursor, source.text + source.length, line, sizeof(line)))
+    {
+        tokenizeLine(line, &tokens);
+        lines++;
+    }
+    tokenize_allocations = allocations - tokenize_allocations;
+
+    /* The first pass only grows the arena */
+    new_blocks = count_blocks(&arena);
+    pass_allocations = allocations;
+    firstPass(&source, file_name, &IC, &labels, &externList, &entryList, &dataSegment, &program);
+    pass_allocations = allocations - pass_allocations;
+    new_blocks = count_blocks(&arena) - new_blocks;
+
+    passed = tokenize_allocations == 0 && pass_allocations == new_blocks ? TRUE : FALSE;
+    printf("%-28s %8ld lines  tokenizeLine: %ld allocations  firstPass: %ld allocations, %ld arena blocks  %s\n",
+           file_name, lines, tokenize_allocations, pass_allocations, new_blocks, passed ? "PASS" : "FAIL");
+
+    close_source_file(&input);
+    arena_free(&arena);
+    return passed;
+}
+
+int main(int argc, char *argv[])
+{
+    Bool passed = TRUE;
+    int i;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s file...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    for (i = 1; i < argc; i++)
+    {
+        if (!check_file(argv[i]))
+        {
+            passed = FALSE;
+        }
+    }
+    free_definition_cache();
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
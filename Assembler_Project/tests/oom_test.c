@@ -0,0 +1,160 @@
+/*
+ * Test that the library survives running out of memory.
+ * The program is linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc, so any one allocation
+ * of the assembler can be made to fail. For every given source file, asm_assemble_with is run once
+ * without failures for the expected result, then again with the first, second, ... allocation
+ * failing, until a run makes fewer allocations than the one that should fail. Every run must
+ * return, either ASM_SYSTEM_ERROR with an empty result, or the expected result: a definition
+ * that cannot be cached is only parsed again. The macro definition cache is released before
+ * every run, so its allocations fail too.
+ * Prints the number of runs of every file and exits with a failure if any result is wrong.
+ *
+ * Usage: oom_test file...  (the file names are given without the .as extension)
+ */
+#include "../asm_library.h"
+#include "../general_functions.h"
+#include "../pre_assembler.h"
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *memory, size_t size);
+
+static long allocations = 0; /* Number of calls to malloc, calloc and realloc so far */
+static long failing = -1;    /* The number of the call that fails, -1 for none */
+
+void *__wrap_malloc(size_t size)
+{
+    return ++allocations == failing ? NULL : __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    return ++allocations == failing ? NULL : __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *memory, size_t size)
+{
+    return ++allocations == failing ? NULL : __real_realloc(memory, size);
+}
+
+/* Returns TRUE if two outputs of a result hold the same text */
+static Bool same_output(const char *a, size_t a_length, const char *b, size_t b_length)
+{
+    if (a == NULL || b == NULL)
+    {
+        return a == b ? TRUE : FALSE;
+    }
+    return a_length == b_length && memcmp(a, b, a_length) == 0 ? TRUE : FALSE;
+}
+
+/* Returns TRUE if a result holds the same outputs as the expected one */
+static Bool same_result(const asm_result *a, const asm_result *b)
+{
+    return same_output(a->object, a->object_length, b->object, b->object_length) &&
+           same_output(a->entries, a->entries_length, b->entries, b->entries_length) &&
+           same_output(a->externs, a->externs_length, b->externs, b->externs_length) &&
+           same_output(a->diagnostics, a->diagnostics_length, b->diagnostics, b->diagnostics_length) &&
+           a->assembled == b->assembled ? TRUE : FALSE;
+}
+
+/* Returns TRUE if a result was left empty */
+static Bool empty_result(const asm_result *result)
+{
+    return result->object == NULL && result->entries == NULL && result->externs == NULL &&
+           result->diagnostics == NULL && result->expanded == NULL && result->assembled == 0 ? TRUE : FALSE;
+}
+
+/*
+ * Assembles a source with its first, second, ... allocation failing until every allocation of a
+ * run was made to fail once, and counts the runs and the ones that returned ASM_SYSTEM_ERROR.
+ * Returns FALSE as soon as a result is wrong.
+ */
+static Bool fail_every_allocation(asm_context *context, char *file_name, const SourceFile *input,
+                                  int expected_status, const asm_result *expected, long *runs, long *failures)
+{
+    asm_result result;
+    int status;
+    Bool passed = TRUE;
+    Bool exhausted = FALSE;
+    long n;
+
+    for (n = 1; passed && !exhausted; n++)
+    {
+        asm_release_caches();
+        failing = allocations + n;
+        status = asm_assemble_with(context, file_name, input->data, input->size, ASM_EMIT_EXPANDED, &result);
+        exhausted = allocations < failing ? TRUE : FALSE;
+        failing = -1;
+        (*runs)++;
+        if (status == ASM_SYSTEM_ERROR && !exhausted)
+        {
+            (*failures)++;
+            passed = empty_result(&result);
+        }
+        else
+        {
+            passed = status == expected_status && same_result(&result, expected) ? TRUE : FALSE;
+        }
+        asm_result_free(&result);
+    }
+    return passed;
+}
+
+/*
+ * Assembles a file with every allocation failing in turn, on a fresh arena and on a context.
+ * Returns FALSE if the file cannot be read or a result is wrong.
+ */
+static Bool check_file(char *file_name, asm_context *context)
+{
+    SourceFile input;
+    asm_result expected;
+    char path[FILENAME_MAX];
+    int expected_status;
+    long failures = 0;
+    long runs = 0;
+    Bool passed;
+
+    if (strlen(file_name) + END_OF_FILE + 1 > sizeof(path))
+    {
+        return FALSE;
+    }
+    my_snprintf(path, sizeof(path), "%s%s", file_name, ".as");
+    if (!open_source_file(&input, path))
+    {
+        fprintf(stderr, "Error opening input file: %s\n", path);
+        return FALSE;
+    }
+
+    asm_release_caches();
+    expected_status = asm_assemble_with(NULL, file_name, input.data, input.size, ASM_EMIT_EXPANDED, &expected);
+    passed = fail_every_allocation(NULL, file_name, &input, expected_status, &expected, &runs, &failures) &&
+             fail_every_allocation(context, file_name, &input, expected_status, &expected, &runs, &failures) ? TRUE : FALSE;
+    printf("%-36s %6ld runs, %6ld ASM_SYSTEM_ERROR  %s\n", file_name, runs, failures, passed ? "PASS" : "FAIL");
+
+    asm_result_free(&expected);
+    close_source_file(&input);
+    return passed;
+}
+
+int main(int argc, char *argv[])
+{
+    asm_context *context = asm_context_create();
+    Bool passed = TRUE;
+    int i;
+
+    if (argc < 2 || context == NULL)
+    {
+        fprintf(stderr, "Usage: %s file...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    for (i = 1; i < argc; i++)
+    {
+        if (!check_file(argv[i], context))
+        {
+            passed = FALSE;
+        }
+    }
+    asm_context_free(context);
+    asm_release_caches();
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -4,35 +4,20 @@
 
 
 /* 
- * Function to check if a given method is valid based on an array of valid methods.
+ * Function to check if a given method is in a set of valid methods.
  * 
- * This function iterates through an array of valid methods and checks if the provided
- * method is included in the array. The array of valid methods must be terminated by 
- * a sentinel value of -1 to indicate the end of the list.
+ * The set has the METHOD_BIT of each valid method, so the check is a single AND.
  * 
- * @param method: The method to check for validity.
- * @param valid_methods: An array of valid methods, ending with -1 to mark the end of the list.
+ * @param method: The method to check for validity (-1 for an invalid operand).
+ * @param valid_methods: The set of valid methods.
  * 
- * @return: TRUE if the method is found in the array of valid methods, FALSE otherwise.
+ * @return: TRUE if the method is in the set of valid methods, FALSE otherwise.
  */
-int is_valid_method(int method, int valid_methods[]) 
+int is_valid_method(int method, unsigned int valid_methods) 
 {
-    int i;
-   
-    for (i = 0; valid_methods[i] != -1; i++) 
-    {
-        
-        if (method == valid_methods[i]) 
-        {
-            return TRUE;
-        }
-    }
-    return FALSE;
+    return method >= 0 && (valid_methods & METHOD_BIT(method)) != 0;
 }
 
-
-
-
 /* 
  * Function to get the addressing method from the operand.
  * 
@@ -105,15 +90,12 @@ int get_addressing_method(char *operand, int *extraValue)
 
 
 /* Function to validate if a label is valid */
-Bool is_valid_label(char *label,Operation *all_operations) 
+Bool is_valid_label(char *label) 
 {
   	int i;
-	for (i = 0; i < 16; i++) 
+	if (find_operation(label, strlen(label)) != NULL) 
   	{
-		if (strcmp(label, all_operations[i].name) == 0) 
-    		{
-      			return FALSE;
-		}
+      		return FALSE;
     	}
 
     	/* Ensure the first character is a letter */
@@ -141,90 +123,65 @@ Bool is_valid_label(char *label,Operation *all_operations)
  *
  * Parameters:
  *     array - A pointer to the InstructionArray to be initialized.
- *     initial_capacity - The initial number of instructions that the array can hold.
+ *     initial_capacity - The initial number of words that the array can hold.
+ *     arena - The arena that owns the memory of the array.
  */
-void init_instruction_array(InstructionArray *array, size_t initial_capacity) 
+void init_instruction_array(InstructionArray *array, size_t initial_capacity, Arena *arena) 
 {
-        array->instructions = malloc(initial_capacity * sizeof(Instruction));
+        array->words = arena_alloc(arena, initial_capacity * sizeof(uint16_t));
         array->size = 0;
         array->capacity = initial_capacity;
+        array->arena = arena;
 }
 
 /* 
- * Adds a detailed encoded instruction to the instruction array.
- * If the array's capacity is reached, it is doubled to accommodate more instructions.
+ * Appends a machine word to the instruction array.
+ * If the array's capacity is reached, it is doubled to accommodate more words.
  *
  * Parameters:
- *     array - A pointer to the InstructionArray where the instruction will be added.
- *     instr - The EncodedInstruction to be added to the array.
+ *     array - A pointer to the InstructionArray where the word will be added.
+ *     word - The encoded 15-bit word.
  */
-void add_detailed_instruction(InstructionArray *array, EncodedInstruction instr) 
-{	
+static void add_word(InstructionArray *array, uint16_t word) 
+{
         if (array->size >= array->capacity) {
+                array->words = (uint16_t *)arena_grow(array->arena, array->words,
+                        array->capacity * sizeof(uint16_t), array->capacity * 2 * sizeof(uint16_t));
                 array->capacity *= 2;
-                array->instructions = realloc(array->instructions, array->capacity * sizeof(Instruction));
         }
-        array->instructions[array->size].instruction.detailed = instr;
-        array->instructions[array->size].isRaw = 0;  /* Indicates that the instruction is detailed */  
-	array->instructions[array->size].isSimple = 0;  /* Indicates that the instruction is detailed */     
-	array->size++;
+        array->words[array->size++] = word;
 }
 
-
-
 /* 
- * Frees the memory allocated for the instruction array and resets its fields.
- * This function should be called when the array is no longer needed to avoid memory leaks.
+ * Adds a detailed encoded instruction to the instruction array.
+ * The fields are packed into the word as: opcode in bits 11-14, source operand in bits 7-10,
+ * destination operand in bits 3-6 and ARE in bits 0-2.
  *
  * Parameters:
- *     array - A pointer to the InstructionArray to be freed.
+ *     array - A pointer to the InstructionArray where the instruction will be added.
+ *     instr - The EncodedInstruction to be added to the array.
  */
-void free_instruction_array(InstructionArray *array) 
-{
-        free(array->instructions);
-        array->instructions = NULL;
-        array->size = 0;
-        array->capacity = 0;
+void add_detailed_instruction(InstructionArray *array, EncodedInstruction instr) 
+{	
+        add_word(array, (uint16_t)(instr.ARE | (instr.destOperand << 3) | (instr.srcOperand << 7) | (instr.opcode << 11)));
 }
 
+
+
 /* 
- * Prints the details of an encoded instruction.
- * The printed information includes the opcode, source operand, destination operand, and ARE fields.
+ * Prints the fields of a machine word.
+ * The printed information includes the fields of an operation word, the ARE field and the binary value.
  *
  * Parameters:
- *     instruction - The EncodedInstruction to be printed.
+ *     word - The word to be printed.
  */
-void print_instruction(Instruction *inst) 
+void print_instruction(uint16_t word) 
 {
-    uint16_t value = 0;
-    if (inst->isRaw) 
-    {
-        /* Print raw instruction's ARE and num fields */
-	 printf("RAW Instruction:\n");
-        printf("ARE: %u, Num: %u\n", inst->instruction.raw.ARE, inst->instruction.raw.num);
-    } 
-
-    else if (inst->isSimple) 
-    {
-        /* Print simple instruction details */
-        printf("Simple Instruction:\n");
-        printf("  ARE: 0x%X\n", inst->instruction.simple.ARE);
-        printf("  Destination Operand: 0x%X\n", inst->instruction.simple.destOperand);
-        printf("  Source Operand: 0x%X\n", inst->instruction.simple.srcOperand);
-    } 
-    else 
-    { 
-	  
-        /* Print detailed instruction encoding */
-	printf("detailed Instruction:\n");        
-        value |= (inst->instruction.detailed.ARE & 0x7) << 12;
-        value |= (inst->instruction.detailed.srcOperand & 0xF) << 8;
-        value |= (inst->instruction.detailed.destOperand & 0xF) << 4;
-        value |= (inst->instruction.detailed.opcode & 0xF);
-        
-        /* Print the encoded instruction in binary format */
-        print_binary(value);
-    }
+        printf("  Opcode: 0x%X\n", (word >> 11) & 0xF);
+        printf("  Source Operand: 0x%X\n", (word >> 7) & 0xF);
+        printf("  Destination Operand: 0x%X\n", (word >> 3) & 0xF);
+        printf("  ARE: 0x%X\n", word & ARE_MASK);
+        print_binary(word);
 }
 
 
@@ -282,98 +239,10 @@ void print_binary(uint16_t value)
 
 
 
-/**
- * Appends a new node to the end of a linked list.
- * 
- * Allocates memory for a new node and initializes its fields with the provided values.
- * The new node is added to the end of the linked list. If the list is empty, the new
- * node becomes the head of the list.
- * 
- * @param head_ref: A pointer to a pointer to the head of the list. This allows for 
- *                  modification of the head pointer if the list is empty.
- * @param line_number: The line number to be stored in the new node.
- * @param label: A string representing the label to be stored in the new node.
- * @param ic: An integer value representing the IC (Instruction Counter) to be stored in the new node.
- */
-void append_node(Node **head_ref, int line_number, const char *label, int ic) 
-{
-    Node *new_node = (Node *)malloc(sizeof(Node));
-    Node *last;
-    if (new_node == NULL) 
-    {
-        fprintf(stderr,"Failed to allocate memory for new node");
-        return;
-    }
-    
-    new_node->ic = ic;
-    new_node->line_number = line_number;
-    new_node->line_text = my_strdup(label);
-    if (new_node->line_text == NULL) 
-    {
-        fprintf(stderr,"Failed to duplicate string");
-        free(new_node);
-        return;
-    }
-    new_node->next = NULL;
-    
-    if (*head_ref == NULL) 
-    {
-        *head_ref = new_node;
-        return;
-    }
-   
-    last = *head_ref;
-    while (last->next != NULL)
-    {
-        last = last->next;
-    }
-    
-    last->next = new_node;
-}
-
-/**
- * Prints the contents of a linked list of nodes.
- * 
- * Iterates through the linked list and prints the line number, IC, and label for each node.
- * 
- * @param head: A pointer to the head of the linked list.
- */
-void print_list(Node *head) 
-{
-    Node *current = head;
-    while (current != NULL) 
-    {
-        printf("Line %d: ic:%d label:%s\n", current->line_number, current->ic, current->line_text);
-        current = current->next;
-    }
-}
-
-/**
- * Frees all nodes in a linked list and their associated resources.
- * 
- * Iterates through the linked list, frees the memory allocated for each node's string
- * and then frees the node itself. Moves to the next node before freeing the current node.
- * 
- * @param head: A pointer to the head of the linked list.
- */
-void free_list(Node* head) 
-{
-    Node* current = head;
-    Node* next;
-    while (current != NULL) 
-    {
-        next = current->next;
-        free(current->line_text); /* Free the string */
-        free(current); /* Free the node */
-        current = next;
-    }
-}
-
 /**
  * Prints the contents of an array of instructions.
  * 
- * Iterates through the array of instructions and prints details based on the type of
- * each instruction. Instructions can be raw, simple, or detailed.
+ * Iterates through the words of the array and prints the fields of each one.
  * 
  * @param array: A pointer to the `InstructionArray` struct containing the instructions.
  */
@@ -381,105 +250,39 @@ void printInstructionArray(const InstructionArray *array)
 {
     size_t i;
     
-    /* Iterate over all instructions in the array */
+    /* Iterate over all words in the array */
     for (i = 0; i < array->size; i++) 
     {
-        /* Pointer to the current instruction */
-        const Instruction *inst = &array->instructions[i];
-
-        /* Check if the instruction is of type raw */
-        if (inst->isRaw) 
-        {
-            /* Print the raw value of ARE and num */
-            printf("Instruction %lu (Raw): ARE: %u, Num: 0x%03X\n", 
-                   (unsigned long)(i + 1), 
-                   inst->instruction.raw.ARE, 
-                   inst->instruction.raw.num);
-        } 
-        else if (inst->isSimple) 
-        {
-            /* Print the details of the simple instruction */
-            printf("Instruction %lu (Simple):\n", (unsigned long)(i + 1));
-            printf("  ARE: 0x%X\n", inst->instruction.simple.ARE);
-            printf("  Destination Operand: 0x%X\n", inst->instruction.simple.destOperand);
-            printf("  Source Operand: 0x%X\n", inst->instruction.simple.srcOperand);
-        } 
-        else 
-        {
-            /* Print the details of the detailed instruction */
-            printf("Instruction %lu (Detailed):\n", (unsigned long)(i + 1));
-            printf("  Opcode: 0x%X\n", inst->instruction.detailed.opcode);
-            printf("  Source Operand: 0x%X\n", inst->instruction.detailed.srcOperand);
-            printf("  Destination Operand: 0x%X\n", inst->instruction.detailed.destOperand);
-            printf("  ARE: 0x%X\n", inst->instruction.detailed.ARE);
-        }
+        printf("Instruction %lu: %05o\n", (unsigned long)(i + 1), array->words[i]);
+        print_instruction(array->words[i]);
     }
 }
 
 /**
  * Adds a new simple instruction to the instruction array.
  * 
- * Checks if the array needs to be resized. If the current capacity is reached,
- * it doubles the capacity of the array. Then, a new `Instruction` is created and
- * initialized with the provided `SimpleInstruction`. The `Instruction` is added to 
- * the end of the array, and the size of the array is incremented.
+ * The two register numbers are packed into the word as: source register in bits 6-8,
+ * destination register in bits 3-5 and ARE in bits 0-2.
  * 
  * @param array: A pointer to the `InstructionArray` struct where the new instruction will be added.
  * @param simpleInstruction: The `SimpleInstruction` to be added to the instruction array.
  */
 void addSimpleInstruction(InstructionArray *array, SimpleInstruction simpleInstruction) 
 {
-    Instruction instruction;
-    /* Check if we need to resize the array */
-    if (array->size >= array->capacity) {
-        array->capacity *= 2;
-        array->instructions = (Instruction *)realloc(array->instructions, array->capacity * sizeof(Instruction));
-        if (array->instructions == NULL) {
-            fprintf(stderr,"Failed to reallocate memory");
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    /* Create a new Instruction and set its simple field with the simpleInstruction */
-    instruction.instruction.simple = simpleInstruction;
-    instruction.isRaw = 0;   /* Set the flag to indicate it's not a raw value */
-    instruction.isSimple = 1; /* Set the flag to indicate it's a simple value */
-
-    /* Add the new Instruction to the array */
-    array->instructions[array->size++] = instruction;
+    add_word(array, (uint16_t)(simpleInstruction.ARE | (simpleInstruction.destOperand << 3) | (simpleInstruction.srcOperand << 6)));
 }
 
 /**
  * Adds a new raw instruction to the instruction array.
  * 
- * Checks if the array needs to be resized. If the current capacity is reached,
- * it doubles the capacity of the array. Then, a new `Instruction` is created and
- * initialized with the provided `RawInstruction`. The `Instruction` is added to 
- * the end of the array, and the size of the array is incremented.
+ * The 12-bit number is packed into bits 3-14 of the word and ARE into bits 0-2.
  * 
  * @param array: A pointer to the `InstructionArray` struct where the new instruction will be added.
  * @param rawInstruction: The `RawInstruction` to be added to the instruction array.
  */
 void addRawInstruction(InstructionArray *array, RawInstruction rawInstruction) 
 {
-    Instruction instruction;
-    /* Check if we need to resize the array */
-    if (array->size >= array->capacity) {
-        array->capacity *= 2;
-        array->instructions = (Instruction *)realloc(array->instructions, array->capacity * sizeof(Instruction));
-        if (array->instructions == NULL) {
-            fprintf(stderr,"Failed to reallocate memory");
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    /* Create a new Instruction and set its raw field with the rawInstruction */
-    instruction.instruction.raw = rawInstruction;
-    instruction.isRaw = 1;   /* Set the flag to indicate it's a raw value */
-    instruction.isSimple = 0; /* Set the flag to indicate it's not a simple value */
-
-    /* Add the new Instruction to the array */
-    array->instructions[array->size++] = instruction;
+    add_word(array, (uint16_t)(rawInstruction.ARE | (rawInstruction.num << 3)));
 }
 
 
@@ -8,20 +8,7 @@
 #include "general_functions.h"
 #include "pre_assembler.h"
 #include "instructions.h"
-
-/* 
- * Structure to represent a node in a linked list of lines.
- * - line_number: The line number in the source file.
- * - ic: The instruction counter.
- * - line_text: The text of the line.
- * - next: Pointer to the next node in the list.
- */
-typedef struct Node {
-    int line_number;
-    int ic;
-    char* line_text;
-    struct Node* next; 
-} Node;
+#include "arena.h"
 
 /* 
  * Structure to represent an encoded instruction.
@@ -61,32 +48,25 @@ typedef struct {
     unsigned int num : 12;       /* 12 bits for number or address of label */
 } RawInstruction;
 
-/* 
- * Structure to represent an instruction which can be detailed, simple, or raw.
- * - instruction: Union of detailed, simple, and raw instruction structures.
- * - isRaw: Flag indicating whether the instruction is of raw type.
- * - isSimple: Flag indicating whether the instruction is of simple type.
- */
-typedef struct {
-    union {
-        EncodedInstruction detailed; /* Detailed structure with fields like opcode, srcOperand, etc. */
-        SimpleInstruction simple;    /* Simple structure with 3 bits for each field */
-        RawInstruction raw;          /* Raw structure with ARE and number fields */
-    } instruction;
-    int isRaw;      /* Flag indicating if the instruction is of raw type (15-bit value) */
-    int isSimple;   /* Flag indicating if the instruction is of simple type */
-} Instruction;
+/* The ARE field (the 3 lowest bits of every word) */
+#define ARE_MASK 7          /* Mask of the ARE field */
+#define ARE_ABSOLUTE 4      /* A: the word does not depend on where the program is loaded */
+#define ARE_RELOCATABLE 2   /* R: the word holds the address of a label in the file */
+#define ARE_EXTERNAL 1      /* E: the word holds the address of an external label */
 
 /* 
- * Structure to represent an array of instructions.
- * - instructions: Pointer to an array of Instruction structures.
- * - size: Current number of instructions in the array.
- * - capacity: Allocated capacity for the instructions array.
+ * Structure to represent the instruction image: the final 15-bit machine words, in order.
+ * The words are encoded by the second pass from the statements of the program, once every label is known.
+ * - words: Pointer to an array of encoded words.
+ * - size: Current number of words in the array.
+ * - capacity: Allocated capacity for the words array.
+ * - arena: Arena the words are allocated from.
  */
 typedef struct {
-    Instruction *instructions;
+    uint16_t *words;
     size_t size;
     size_t capacity;
+    Arena *arena;
 } InstructionArray;
 
 /* 
@@ -101,19 +81,31 @@ typedef enum {
     TWO_OPERANDS
 } OperationType;
 
+/* 
+ * Bits of the addressing methods in a set of valid methods, numbered as returned
+ * by get_addressing_method.
+ */
+#define METHOD_BIT(method) (1u << (method))
+#define METHOD_IMMEDIATE METHOD_BIT(0)          /* #number */
+#define METHOD_DIRECT METHOD_BIT(1)             /* label */
+#define METHOD_INDIRECT_REGISTER METHOD_BIT(2)  /* *r0 to *r7 */
+#define METHOD_DIRECT_REGISTER METHOD_BIT(3)    /* r0 to r7 */
+#define METHODS_NONE 0u
+#define METHODS_ALL (METHOD_IMMEDIATE | METHOD_DIRECT | METHOD_INDIRECT_REGISTER | METHOD_DIRECT_REGISTER)
+
 /* 
  * Structure to hold operation information.
  * - name: Name of the operation.
  * - type: Type of operation (NO_OPERANDS, ONE_OPERAND, TWO_OPERANDS).
- * - destMethods: Valid destination addressing methods.
- * - sourceMethods: Valid source addressing methods.
+ * - destMethods: Set of valid destination addressing methods.
+ * - sourceMethods: Set of valid source addressing methods.
  * - code: Numeric code for the operation.
  */
 typedef struct {
-    char *name;                /* Name of the operation */
+    const char *name;          /* Name of the operation */
     OperationType type;        /* Type of operation: NO_OPERANDS, ONE_OPERAND, TWO_OPERANDS */
-    int destMethods[5];       /* Valid destination addressing methods */
-    int sourceMethods[5];     /* Valid source addressing methods */
+    unsigned int destMethods;  /* Valid destination addressing methods, one METHOD_BIT each */
+    unsigned int sourceMethods;/* Valid source addressing methods, one METHOD_BIT each */
     int code;                  /* Numeric code for the operation */
 } Operation;
 
@@ -121,10 +113,10 @@ typedef struct {
  * Checks if the given addressing method is valid.
  * 
  * @param method: The addressing method to check.
- * @param valid_methods: Array of valid methods.
+ * @param valid_methods: Set of valid methods (METHOD_BIT of each method).
  * @return: 1 if the method is valid, 0 otherwise.
  */
-int is_valid_method(int method, int valid_methods[]);
+int is_valid_method(int method, unsigned int valid_methods);
 
 /* 
  * Determines the addressing method for a given operand and retrieves any additional value.
@@ -140,11 +132,12 @@ int get_addressing_method(char *operand, int *extraValue);
  * 
  * @param array: Pointer to the InstructionArray to initialize.
  * @param initial_capacity: The initial capacity of the array.
+ * @param arena: The arena that owns the memory of the array.
  */
-void init_instruction_array(InstructionArray *array, size_t initial_capacity);
+void init_instruction_array(InstructionArray *array, size_t initial_capacity, Arena *arena);
 
 /* 
- * Adds a detailed (encoded) instruction to the InstructionArray.
+ * Adds a detailed (encoded) instruction to the InstructionArray as a machine word.
  * 
  * @param array: Pointer to the InstructionArray.
  * @param instr: The EncodedInstruction to add.
@@ -152,18 +145,11 @@ void init_instruction_array(InstructionArray *array, size_t initial_capacity);
 void add_detailed_instruction(InstructionArray *array, EncodedInstruction instr);
 
 /* 
- * Frees all memory allocated for an InstructionArray.
- * 
- * @param array: Pointer to the InstructionArray to free.
- */
-void free_instruction_array(InstructionArray *array);
-
-/* 
- * Prints the details of an Instruction.
+ * Prints the fields of a machine word.
  * 
- * @param inst: Pointer to the Instruction to print.
+ * @param word: The word to print.
  */
-void print_instruction(Instruction *inst);
+void print_instruction(uint16_t word);
 
 /* 
  * Prints the binary representation of a 16-bit value.
@@ -175,35 +161,10 @@ void print_binary(uint16_t value);
 /* 
  * Validates if the given label is correct according to operation rules.
  * 
- * @param label: The label to check.
- * @param all_operations: Pointer to an array of all operations for validation.
+ * @param label: The label to check, which must not be an operation name.
  * @return: TRUE if the label is valid, FALSE otherwise.
  */
-Bool is_valid_label(char *label, Operation* all_operations);
-
-/* 
- * Appends a new node to the end of a linked list.
- * 
- * @param head: Pointer to the head of the linked list.
- * @param line_number: Line number to store in the new node.
- * @param line_text: Text of the line to store in the new node.
- * @param ic: Instruction counter to store in the new node.
- */
-void append_node(Node** head, int line_number, const char* line_text, int ic);
-
-/* 
- * Prints all nodes in a linked list.
- * 
- * @param head: Pointer to the head of the linked list.
- */
-void print_list(Node* head);
-
-/* 
- * Frees all nodes in a linked list.
- * 
- * @param head: Pointer to the head of the linked list.
- */
-void free_list(Node* head);
+Bool is_valid_label(char *label);
 
 /* 
  * Prints the content of an InstructionArray.
@@ -213,7 +174,7 @@ void free_list(Node* head);
 void printInstructionArray(const InstructionArray *array);
 
 /* 
- * Adds a simple instruction to the InstructionArray.
+ * Adds a simple instruction (two registers) to the InstructionArray as a machine word.
  * 
  * @param array: Pointer to the InstructionArray.
  * @param simpleInstruction: The SimpleInstruction to add.
@@ -221,7 +182,7 @@ void printInstructionArray(const InstructionArray *array);
 void addSimpleInstruction(InstructionArray *array, SimpleInstruction simpleInstruction);
 
 /* 
- * Adds a raw instruction to the InstructionArray.
+ * Adds a raw instruction (a number or an address) to the InstructionArray as a machine word.
  * 
  * @param array: Pointer to the InstructionArray.
  * @param rawInstruction: The RawInstruction to add.
@@ -1,117 +1,345 @@
+#include <pthread.h>
+
 #include "util_pre_assembler.h"
 #include "general_functions.h"
+#include "instructions.h"
+#include "char_class.h"
+
+/* The macro definitions cached across the files of the run, allocated from their own arena */
+static CachedDefinition **definition_slots = NULL;
+static int definition_count = 0;
+static int definition_capacity = 0;
+static Arena definition_arena;
+static pthread_mutex_t definition_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /* Function to check if a line contains only whitespace */
 int is_whitespace(const char *line)
 {
-    	while (*line)
+    	const char *end = line + strlen(line);
+    	return skip_class(line, end, CHAR_WHITESPACE) == end;
+}
+
+/* Function to check if a macro name is valid (returns 1 if it is an operation or data directive name) */
+int is_valid_macro_name(const char *name)
+{
+	if (find_operation(name, strlen(name)) != NULL)
+	{
+		return 1;
+	}
+	return strcmp(name, ".data") == 0 || strcmp(name, ".string") == 0;
+}
+
+/* Function to initialize an empty expanded source */
+void init_expanded_source(ExpandedSource *source, Arena *arena)
+{
+    	source->text = NULL;
+    	source->length = 0;
+    	source->capacity = 0;
+    	source->arena = arena;
+    	source->lines_read = 0;
+    	source->macro_calls = 0;
+}
+
+/* Function to append characters to an expanded source, doubling its capacity when it is full */
+void append_to_source(ExpandedSource *source, const char *text, size_t length)
+{
+    	if (source->length + length > source->capacity)
     	{
-        	if (!isspace((unsigned char)*line))
+        	size_t capacity = source->capacity == 0 ? 4096 : source->capacity * 2;
+        	while (capacity < source->length + length)
         	{
-            		return 0;
+            		capacity *= 2;
         	}
-        	line++;
+        	source->text = (char *)arena_grow(source->arena, source->text, source->capacity, capacity);
+        	source->capacity = capacity;
     	}
-    	return 1;
+    	memcpy(source->text + source->length, text, length);
+    	source->length += length;
 }
 
-/* Function to check if a macro name is valid */
-int is_valid_macro_name(const char *name)
+/* Function to find the slot of a name, or the empty slot where it would be inserted */
+static Macro **find_macro_slot(Macro **slots, int capacity, const char *name, size_t length)
 {
-	int i;
-	/* Array of string literals (array of pointers to characters)*/
-    	const char *commands[] = 
-	{
-		"mov",
-		"cmp",
-		"add",
-		"sub",
-		"lea",
-        	"clr",
-        	"not",
-       		"inc",
-       		"dec",
-        	"jmp",
-        	".data",
-		".string",
-        	"bne",
-        	"red",
-        	"prn",
-        	"jsr",
-        	"rts",
-        	"stop"
-    	};
-	for (i = 0; i < 18; i++)
-	{
-		if (strcmp(name, commands[i]) == 0)
-		{
-			return 1;
-		}
-	}
-	return 0;	
+    	unsigned long mask = (unsigned long)capacity - 1;
+    	unsigned long i = hashBytes(name, length) & mask;
+
+    	/* Linear probing until the name or an empty slot is found */
+    	while (slots[i] != NULL && (strncmp(slots[i]->name, name, length) != 0 || slots[i]->name[length] != '\0'))
+    	{
+        	i = (i + 1) & mask;
+    	}
+    	return &slots[i];
 }
 
-/* Function to find a macro by name in the macro list */
-Macro *find_macro(Macro *macro_list, const char *name)
+/* Function to allocate an array of empty slots from the arena */
+static Macro **alloc_macro_slots(Arena *arena, int capacity)
 {
-    	while (macro_list)
+    	Macro **slots = (Macro **)arena_alloc(arena, capacity * sizeof(Macro *));
+    	int i;
+    	for (i = 0; i < capacity; i++)
     	{
-        	if (strcmp(macro_list->name, name) == 0)
+        	slots[i] = NULL;
+    	}
+    	return slots;
+}
+
+/* Function to initialize an empty macro table */
+void init_macro_table(MacroTable *table, Arena *arena)
+{
+    	table->capacity = MACRO_TABLE_INITIAL_CAPACITY;
+    	table->size = 0;
+    	table->min_length = 0;
+    	table->max_length = 0;
+    	memset(table->first_chars, 0, sizeof(table->first_chars));
+    	table->arena = arena;
+    	table->slots = alloc_macro_slots(arena, table->capacity);
+}
+
+/* Function to find a macro by name in the macro table */
+Macro *find_macro(const MacroTable *table, const char *name, size_t length)
+{
+    	unsigned char first;
+
+    	/* Reject names of a length or a first character that no macro has before hashing them */
+    	if (length == 0 || length < table->min_length || length > table->max_length)
+    	{
+        	return NULL;
+    	}
+    	first = (unsigned char)name[0];
+    	if (!(table->first_chars[first >> 3] & (1 << (first & 7))))
+    	{
+        	return NULL;
+    	}
+    	return *find_macro_slot(table->slots, table->capacity, name, length);
+}
+
+/* Function to double the capacity of the macro table and rehash all macros */
+static void grow_macro_table(MacroTable *table)
+{
+    	int i;
+    	int capacity = table->capacity * 2;
+    	Macro **slots = alloc_macro_slots(table->arena, capacity);
+
+    	for (i = 0; i < table->capacity; i++)
+    	{
+        	if (table->slots[i] != NULL)
         	{
-            		return macro_list;
+            		*find_macro_slot(slots, capacity, table->slots[i]->name, strlen(table->slots[i]->name)) = table->slots[i];
         	}
-        	macro_list = macro_list->next;
     	}
-    	return NULL;
+    	table->slots = slots;
+    	table->capacity = capacity;
 }
 
-/* Function to create a new macro */
-Macro *create_macro(const char *name)
+/* Function to create a new macro and add it to the macro table */
+Macro *add_macro(MacroTable *table, const char *name)
 {
-    	Macro *macro = (Macro *)malloc(sizeof(Macro));
-    	macro->name = my_strdup(name);
+    	Macro *macro = create_macro(name, table->arena);
+    	unsigned char first = (unsigned char)name[0];
+    	size_t length = strlen(name);
+
+    	/* Keep the load factor under 3/4 so probe sequences stay short */
+    	if ((table->size + 1) * 4 > table->capacity * 3)
+    	{
+        	grow_macro_table(table);
+    	}
+    	*find_macro_slot(table->slots, table->capacity, name, length) = macro;
+    	table->size++;
+
+    	/* Update the quick reject filters */
+    	table->first_chars[first >> 3] |= (unsigned char)(1 << (first & 7));
+    	if (table->size == 1 || length < table->min_length)
+    	{
+        	table->min_length = length;
+    	}
+    	if (length > table->max_length)
+    	{
+        	table->max_length = length;
+    	}
+    	return macro;
+}
+
+/* Function to create a new macro in the arena */
+Macro *create_macro(const char *name, Arena *arena)
+{
+    	Macro *macro = (Macro *)arena_alloc(arena, sizeof(Macro));
+    	macro->name = arena_strdup(arena, name);
+    	macro->arena = arena;
     	macro->lines = NULL;
     	macro->line_count = 0;
     	macro->line_capacity = 0;
-    	macro->next = NULL;
     	return macro;
 }
 
 /* Function to add a line to a macro */
-void add_line_to_macro(Macro *macro, const char *line)
+void add_line_to_macro(Macro *macro, const char *line, size_t length)
 {
+    	char *copy;
+
+
     	if (macro->line_count >= macro->line_capacity)
     	{
-        	macro->line_capacity = macro->line_capacity == 0 ? 10 : macro->line_capacity * 2;
-        	macro->lines = (char **)realloc(macro->lines, macro->line_capacity * sizeof(char *));
+        	int capacity = macro->line_capacity == 0 ? 10 : macro->line_capacity * 2;
+        	macro->lines = (char **)arena_grow(macro->arena, macro->lines,
+        	                                   macro->line_capacity * sizeof(char *), capacity * sizeof(char *));
+        	macro->line_capacity = capacity;
     	}
-    	macro->lines[macro->line_count] = my_strdup(line);
+    	copy = (char *)arena_alloc(macro->arena, length + 1);
+    	memcpy(copy, line, length);
+    	copy[length] = '\0';
+    	macro->lines[macro->line_count] = copy;
     	macro->line_count++;
 }
 
-/* Function to free memory used by all macros in the list */
-void free_all_macros(Macro *head)
+/* Function to add a macro to the table that shares the lines of a macro that does not change */
+Macro *add_shared_macro(MacroTable *table, const Macro *macro)
+{
+    	Macro *shared = add_macro(table, macro->name);
+    	shared->lines = macro->lines;
+    	shared->line_count = macro->line_count;
+    	shared->line_capacity = macro->line_count;
+    	return shared;
+}
+
+/* 
+ * Function to find the slot of a definition that the source starts with, or the empty slot where it would be inserted.
+ * Definitions with the same macr line share a probe sequence, so each of them is compared until one matches.
+ */
+static CachedDefinition **find_definition_slot(CachedDefinition **slots, int capacity, const char *text, size_t available,
+                                               size_t header_length, unsigned long hash)
 {
-    	Macro *current = head;
-    	while (current != NULL)
+    	unsigned long mask = (unsigned long)capacity - 1;
+    	unsigned long i = hash & mask;
+    	CachedDefinition *cached;
+
+    	/* Linear probing until a matching text or an empty slot is found */
+    	while ((cached = slots[i]) != NULL)
+    	{
+        	if (cached->hash == hash && cached->header_length == header_length && cached->length <= available &&
+        	    memcmp(cached->text, text, cached->length) == 0)
+        	{
+            		break;
+        	}
+        	i = (i + 1) & mask;
+    	}
+    	return &slots[i];
+}
+
+/* Function to find a cached definition that the source starts with */
+const CachedDefinition *find_cached_definition(const char *text, size_t available, size_t header_length)
+{
+    	const CachedDefinition *cached = NULL;
+
+    	pthread_mutex_lock(&definition_lock);
+    	if (definition_slots != NULL)
+    	{
+        	cached = *find_definition_slot(definition_slots, definition_capacity, text, available, header_length,
+        	                               hashBytes(text, header_length));
+    	}
+    	pthread_mutex_unlock(&definition_lock);
+    	return cached;
+}
+
+/* Function to double the capacity of the definition cache and rehash all definitions */
+static void grow_definition_cache(void)
+{
+    	int capacity = definition_capacity == 0 ? DEFINITION_CACHE_INITIAL_CAPACITY : definition_capacity * 2;
+    	CachedDefinition **slots = (CachedDefinition **)arena_alloc(&definition_arena, capacity * sizeof(CachedDefinition *));
+    	CachedDefinition *cached;
+    	int i;
+
+    	for (i = 0; i < capacity; i++)
     	{
-        	Macro *next = current->next;
-        	free_macro(current);
-        	current = next;
+        	slots[i] = NULL;
     	}
+    	for (i = 0; i < definition_capacity; i++)
+    	{
+        	cached = definition_slots[i];
+        	if (cached != NULL)
+        	{
+            		*find_definition_slot(slots, capacity, cached->text, cached->length, cached->header_length, cached->hash) = cached;
+        	}
+    	}
+    	definition_slots = slots;
+    	definition_capacity = capacity;
 }
-/*Function to free memory of a macro*/
-void free_macro(Macro *macro)
+
+/* 
+ * Function to cache a definition that was parsed without errors.
+ * A definition that cannot be allocated is not cached; what the arena allocated for it stays
+ * unused until the cache is released.
+ */
+void cache_definition(const char *text, size_t length, size_t header_length, int line_count, const Macro *macro)
 {
-	int i;
-    	if (macro)
+    	unsigned long hash = hashBytes(text, header_length);
+    	CachedDefinition **slot;
+    	CachedDefinition *cached;
+    	Macro *copy;
+    	jmp_buf on_failure;
+    	int i;
+
+    	pthread_mutex_lock(&definition_lock);
+    	if (definition_slots == NULL)
     	{
-        	free(macro->name);
+        	arena_init(&definition_arena);
+    	}
+    	definition_arena.on_failure = &on_failure;
+    	if (setjmp(on_failure) != 0)
+    	{
+        	definition_arena.on_failure = NULL;
+        	pthread_mutex_unlock(&definition_lock);
+        	return;
+    	}
+
+    	/* A full cache keeps what it has, the definition is parsed again by the next files */
+    	if (definition_arena.bytes + length > (size_t)DEFINITION_CACHE_MAX_BYTES)
+    	{
+        	definition_arena.on_failure = NULL;
+        	pthread_mutex_unlock(&definition_lock);
+        	return;
+    	}
+
+    	/* Keep the load factor under 3/4 so probe sequences stay short */
+    	if ((definition_count + 1) * 4 > definition_capacity * 3)
+    	{
+        	grow_definition_cache();
+    	}
+
+    	/* Another file may have cached the same definition already */
+    	slot = find_definition_slot(definition_slots, definition_capacity, text, length, header_length, hash);
+    	if (*slot == NULL)
+    	{
+        	copy = create_macro(macro->name, &definition_arena);
         	for (i = 0; i < macro->line_count; i++)
         	{
-            		free(macro->lines[i]);
+            		add_line_to_macro(copy, macro->lines[i], strlen(macro->lines[i]));
         	}
-        	free(macro->lines);
-        	free(macro);
+
+        	cached = (CachedDefinition *)arena_alloc(&definition_arena, sizeof(CachedDefinition));
+        	cached->text = (char *)arena_alloc(&definition_arena, length);
+        	memcpy(cached->text, text, length);
+        	cached->length = length;
+        	cached->header_length = header_length;
+        	cached->hash = hash;
+        	cached->line_count = line_count;
+        	cached->macro = copy;
+        	*slot = cached;
+        	definition_count++;
+    	}
+    	definition_arena.on_failure = NULL;
+    	pthread_mutex_unlock(&definition_lock);
+}
+
+/* Function to release all the cached definitions */
+void free_definition_cache(void)
+{
+    	pthread_mutex_lock(&definition_lock);
+    	if (definition_slots != NULL)
+    	{
+        	arena_free(&definition_arena);
+        	definition_slots = NULL;
+        	definition_count = 0;
+        	definition_capacity = 0;
     	}
+    	pthread_mutex_unlock(&definition_lock);
 }
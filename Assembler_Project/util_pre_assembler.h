@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "general_functions.h"
+#include "arena.h"
 
 #define MAX_LINE_LENGTH 81
 
@@ -15,16 +16,97 @@
  * - lines: Array of lines that the macro contains.
  * - line_count: The current number of lines in the macro.
  * - line_capacity: The allocated capacity for the lines array.
- * - next: Pointer to the next macro in the list.
+ * - arena: Arena the macro and its lines are allocated from.
  */
 typedef struct Macro {
     char *name;
     char **lines;
     int line_count;
     int line_capacity;
-    struct Macro *next;
+    Arena *arena;
 } Macro;
 
+#define MACRO_TABLE_INITIAL_CAPACITY 64 /* Initial number of slots in a macro table (a power of two) */
+
+/* 
+ * Structure to represent an open-addressing hash table of macros keyed on the macro name.
+ * Most lines are not macro calls, so the table also keeps the range of name lengths and
+ * the set of first characters of the names to reject such lines without hashing them.
+ * - slots: Array of slots, an empty slot is NULL.
+ * - size: The number of macros in the table.
+ * - capacity: The total number of slots (always a power of two).
+ * - min_length: The length of the shortest macro name.
+ * - max_length: The length of the longest macro name.
+ * - first_chars: Bitmap of the first characters of the macro names.
+ * - arena: Arena the table and the macros are allocated from.
+ */
+typedef struct {
+    Macro **slots;
+    int size;
+    int capacity;
+    size_t min_length;
+    size_t max_length;
+    unsigned char first_chars[32];
+    Arena *arena;
+} MacroTable;
+
+#define DEFINITION_CACHE_INITIAL_CAPACITY 64 /* Initial number of slots in the definition cache (a power of two) */
+#define DEFINITION_CACHE_MAX_BYTES (8L * 1024 * 1024) /* Memory of the definition cache past which no definition is added */
+
+/* 
+ * Structure to represent a macro definition parsed in one file and reused by the next files of the run.
+ * Definitions are found by the hash of their macr line and matched by comparing the whole text.
+ * - text: The definition as it appears in the source, from the macr line through the newline of the endmacr line.
+ * - length: The number of characters in the text.
+ * - header_length: The number of characters in the macr line, including its newline.
+ * - hash: The hash of the macr line.
+ * - line_count: The number of lines in the text.
+ * - macro: The parsed macro.
+ */
+typedef struct {
+    char *text;
+    size_t length;
+    size_t header_length;
+    unsigned long hash;
+    int line_count;
+    Macro *macro;
+} CachedDefinition;
+
+/* 
+ * Structure to represent the source of a file after macro expansion, kept in memory.
+ * - text: The expanded lines, each ending with a newline (not NUL-terminated).
+ * - length: The number of characters in the text.
+ * - capacity: The allocated capacity for the text.
+ * - arena: Arena the text is allocated from.
+ * - lines_read: The number of lines read from the input file.
+ * - macro_calls: The number of macro calls that were replaced with the lines of the macro.
+ */
+typedef struct {
+    char *text;
+    size_t length;
+    size_t capacity;
+    Arena *arena;
+    int lines_read;
+    int macro_calls;
+} ExpandedSource;
+
+/* 
+ * Initializes an empty expanded source.
+ * 
+ * @param source: Pointer to the expanded source to initialize.
+ * @param arena: The arena that owns the text.
+ */
+void init_expanded_source(ExpandedSource *source, Arena *arena);
+
+/* 
+ * Appends characters to the end of an expanded source.
+ * 
+ * @param source: Pointer to the expanded source.
+ * @param text: The characters to append.
+ * @param length: The number of characters to append.
+ */
+void append_to_source(ExpandedSource *source, const char *text, size_t length);
+
 /* 
  * Checks if the given line contains only whitespace characters.
  * 
@@ -42,43 +124,89 @@ int is_whitespace(const char *line);
 int is_valid_macro_name(const char *name);
 
 /* 
- * Finds a macro by its name in the macro list.
+ * Initializes an empty macro table.
  * 
- * @param macro_list: The head of the macro list.
- * @param name: The name of the macro to find.
+ * @param table: Pointer to the macro table to initialize.
+ * @param arena: The arena that owns the memory of the table.
+ */
+void init_macro_table(MacroTable *table, Arena *arena);
+
+/* 
+ * Finds a macro by its name in the macro table.
+ * 
+ * @param table: Pointer to the macro table.
+ * @param name: The name of the macro to find (it does not have to be NUL-terminated).
+ * @param length: The number of characters in the name.
  * @return: Pointer to the macro if found, NULL otherwise.
  */
-Macro *find_macro(Macro *macro_list, const char *name);
+Macro *find_macro(const MacroTable *table, const char *name, size_t length);
+
+/* 
+ * Creates a new macro with the given name and adds it to the macro table.
+ * The table grows when it becomes too full.
+ * 
+ * @param table: Pointer to the macro table.
+ * @param name: The name of the new macro, which must not be in the table.
+ * @return: Pointer to the newly created macro.
+ */
+Macro *add_macro(MacroTable *table, const char *name);
 
 /* 
  * Creates a new macro with the given name.
  * 
  * @param name: The name of the new macro.
+ * @param arena: The arena that owns the memory of the macro.
  * @return: Pointer to the newly created macro.
  */
-Macro *create_macro(const char *name);
+Macro *create_macro(const char *name, Arena *arena);
 
 /* 
  * Adds a line to the specified macro.
  * 
  * @param macro: Pointer to the macro to which the line will be added.
- * @param line: The line to add to the macro.
+ * @param line: The line to add to the macro (it does not have to be NUL-terminated).
+ * @param length: The number of characters in the line.
  */
-void add_line_to_macro(Macro *macro, const char *line);
+void add_line_to_macro(Macro *macro, const char *line, size_t length);
 
 /* 
- * Frees all memory allocated for macros starting from the head of the macro list.
+ * Adds a macro to the macro table that shares the lines of an existing macro, which must not change.
  * 
- * @param head: The head of the macro list.
+ * @param table: Pointer to the macro table.
+ * @param macro: The macro to share, whose name must not be in the table.
+ * @return: Pointer to the new macro in the table.
  */
-void free_all_macros(Macro *head);
+Macro *add_shared_macro(MacroTable *table, const Macro *macro);
 
 /* 
- * Frees memory allocated for a single macro.
+ * Finds a cached macro definition that the source continues with, in this file or an earlier one.
+ * Safe to call from several threads.
  * 
- * @param macro: Pointer to the macro to free.
+ * @param text: The source, from the start of a macr line.
+ * @param available: The number of characters left in the source.
+ * @param header_length: The number of characters in the macr line, including its newline.
+ * @return: Pointer to the cached definition if the source starts with its text, NULL otherwise.
+ */
+const CachedDefinition *find_cached_definition(const char *text, size_t available, size_t header_length);
+
+/* 
+ * Caches a macro definition that was parsed without errors, copying its text and its macro.
+ * Once the cache holds DEFINITION_CACHE_MAX_BYTES, definitions are no longer added until it is
+ * released: the files being expanded share the cached macros, so none can be evicted before then.
+ * Safe to call from several threads.
+ * 
+ * @param text: The definition, from the start of the macr line through the newline of the endmacr line.
+ * @param length: The number of characters in the definition.
+ * @param header_length: The number of characters in the macr line, including its newline.
+ * @param line_count: The number of lines in the definition.
+ * @param macro: The parsed macro.
+ */
+void cache_definition(const char *text, size_t length, size_t header_length, int line_count, const Macro *macro);
+
+/* 
+ * Releases all the cached macro definitions. Must not be called while files are being processed.
  */
-void free_macro(Macro *macro);
+void free_definition_cache(void);
 
 #endif /* UTIL_PRE_ASSEMBLER_H */
 
@@ -0,0 +1,242 @@
+#include <pthread.h>
+
+#include "worker_pool.h"
+#include "assembler.h"
+
+/* 
+ * Structure to represent one file to assemble.
+ * - file_name: The base name of the file.
+ * - errors: Temporary stream the errors of the file are buffered in, created when the file is started.
+ * - output: Temporary stream the reports of the file are buffered in, or stdout when there are none.
+ * - done: Set when the file has been assembled, or left for the main thread.
+ * - deferred: Set when the buffers of the file could not be created, so the main thread
+ *   assembles it unbuffered once the pool has finished.
+ */
+typedef struct {
+    char *file_name;
+    FILE *errors;
+    FILE *output;
+    Bool done;
+    Bool deferred;
+} FileJob;
+
+/* 
+ * Structure to represent the pool shared by the worker threads.
+ * - jobs: The files to assemble, in command-line order.
+ * - count: The number of files.
+ * - next: The index of the next file to hand to a worker.
+ * - flushed: The number of files whose buffers the main thread has written and closed.
+ * - window: The number of files past the flushed ones a worker may start, which bounds the open buffers.
+ * - options: The options that apply to every file.
+ * - lock: Protects next, flushed and the done flags.
+ * - finished: Signalled whenever a file has been assembled.
+ * - drained: Signalled whenever the buffers of a file have been flushed.
+ */
+typedef struct {
+    FileJob *jobs;
+    int count;
+    int next;
+    int flushed;
+    int window;
+    const AssemblerOptions *options;
+    pthread_mutex_t lock;
+    pthread_cond_t finished;
+    pthread_cond_t drained;
+} WorkerPool;
+
+/* 
+ * Creates the buffers of a file. Returns FALSE, with no buffer left open, if one cannot be created.
+ */
+static Bool open_buffers(FileJob *job, const AssemblerOptions *options)
+{
+    job->errors = tmpfile();
+    if (job->errors == NULL)
+    {
+        return FALSE;
+    }
+
+    /* Only the statistics are reported, so the output is buffered only when they are on */
+    if (options->stats == STATS_NONE)
+    {
+        job->output = stdout;
+        return TRUE;
+    }
+    job->output = tmpfile();
+    if (job->output == NULL)
+    {
+        fclose(job->errors);
+        job->errors = NULL;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/* 
+ * The main function of a worker thread: takes the next file until none are left.
+ */
+static void *worker_main(void *arg)
+{
+    WorkerPool *pool = (WorkerPool *)arg;
+    FileJob *job;
+    int i;
+
+    for (;;)
+    {
+        /* Wait until the file is close enough to the ones already flushed */
+        pthread_mutex_lock(&pool->lock);
+        while (pool->next < pool->count && pool->next >= pool->flushed + pool->window)
+        {
+            pthread_cond_wait(&pool->drained, &pool->lock);
+        }
+        i = pool->next++;
+        pthread_mutex_unlock(&pool->lock);
+        if (i >= pool->count)
+        {
+            break;
+        }
+
+        /* Assemble the file with its errors written to its own stream */
+        job = &pool->jobs[i];
+        if (open_buffers(job, pool->options))
+        {
+            setErrorStream(job->errors);
+            setOutputStream(job->output);
+            process_file(job->file_name, pool->options);
+            setErrorStream(NULL);
+            setOutputStream(NULL);
+        }
+        else
+        {
+            job->deferred = TRUE;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        job->done = TRUE;
+        pthread_cond_broadcast(&pool->finished);
+        pthread_mutex_unlock(&pool->lock);
+    }
+    return NULL;
+}
+
+/* 
+ * Copies the buffered errors or reports of a file to their final stream and closes the buffer.
+ */
+static void flush_buffer(FILE *buffered, FILE *stream)
+{
+    char buffer[4096];
+    size_t length;
+
+    if (buffered == NULL || buffered == stream)
+    {
+        return;
+    }
+    rewind(buffered);
+    while ((length = fread(buffer, 1, sizeof(buffer), buffered)) > 0)
+    {
+        fwrite(buffer, 1, length, stream);
+    }
+    fclose(buffered);
+}
+
+/* 
+ * Assembles the files on a pool of worker threads. The main thread waits for the
+ * files in order and writes the errors of each one as soon as it is done.
+ */
+void assemble_files_parallel(char **files, int count, int jobs, const AssemblerOptions *options)
+{
+    WorkerPool pool;
+    pthread_t *threads;
+    int started = 0;
+    int i;
+
+    if (jobs > count)
+    {
+        jobs = count;
+    }
+
+    pool.jobs = (FileJob *)malloc(count * sizeof(FileJob));
+    threads = (pthread_t *)malloc(jobs * sizeof(pthread_t));
+    if (pool.jobs == NULL || threads == NULL)
+    {
+        fprintf(stderr, "Unable to allocate memory for the worker pool\n");
+        exit(EXIT_FAILURE);
+    }
+    pool.count = count;
+    pool.next = 0;
+    pool.flushed = 0;
+    pool.window = jobs * WORKER_POOL_WINDOW;
+    pool.options = options;
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.finished, NULL);
+    pthread_cond_init(&pool.drained, NULL);
+
+    for (i = 0; i < count; i++)
+    {
+        pool.jobs[i].file_name = files[i];
+        pool.jobs[i].errors = NULL;
+        pool.jobs[i].output = NULL;
+        pool.jobs[i].done = FALSE;
+        pool.jobs[i].deferred = FALSE;
+    }
+
+    for (i = 0; i < jobs; i++)
+    {
+        if (pthread_create(&threads[started], NULL, worker_main, &pool) == 0)
+        {
+            started++;
+        }
+    }
+
+    /* If no thread could be started, assemble the files on this thread, one after the other */
+    if (started == 0)
+    {
+        for (i = 0; i < count; i++)
+        {
+            process_file(files[i], options);
+        }
+        count = 0;
+    }
+
+    /* Write the errors and the reports of the files in order, closing their buffers */
+    for (i = 0; i < count; i++)
+    {
+        pthread_mutex_lock(&pool.lock);
+        while (!pool.jobs[i].done)
+        {
+            pthread_cond_wait(&pool.finished, &pool.lock);
+        }
+        pthread_mutex_unlock(&pool.lock);
+        if (pool.jobs[i].deferred)
+        {
+            fprintf(stderr, "Error: cannot buffer the output of file %s, it is assembled after the other files\n",
+                    pool.jobs[i].file_name);
+        }
+        flush_buffer(pool.jobs[i].errors, stderr);
+        flush_buffer(pool.jobs[i].output, stdout);
+
+        pthread_mutex_lock(&pool.lock);
+        pool.flushed = i + 1;
+        pthread_cond_broadcast(&pool.drained);
+        pthread_mutex_unlock(&pool.lock);
+    }
+
+    for (i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    /* The files that could not be buffered are assembled here, with nothing left to interleave with */
+    for (i = 0; i < count; i++)
+    {
+        if (pool.jobs[i].deferred)
+        {
+            process_file(pool.jobs[i].file_name, options);
+        }
+    }
+
+    pthread_cond_destroy(&pool.drained);
+    pthread_cond_destroy(&pool.finished);
+    pthread_mutex_destroy(&pool.lock);
+    free(threads);
+    free(pool.jobs);
+}
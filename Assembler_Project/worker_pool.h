@@ -0,0 +1,27 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "general_functions.h"
+
+#define WORKER_POOL_WINDOW 2 /* Files per worker that may be assembled ahead of the first file not yet written out */
+
+/* 
+ * Assembles files concurrently on a pool of worker threads.
+ * Every file is assembled with its own context, and the errors of each file are
+ * buffered and written to stderr in the order of the files, so they never interleave.
+ * A file is started only when it is less than jobs * WORKER_POOL_WINDOW files ahead of the
+ * first file not yet written out, so the number of open buffers does not grow with the files.
+ * A file whose buffers cannot be created is reported and assembled unbuffered after the others.
+ * 
+ * @param files: The base names of the files to assemble.
+ * @param count: The number of files.
+ * @param jobs: The number of worker threads.
+ * @param options: The options that apply to every file.
+ */
+void assemble_files_parallel(char **files, int count, int jobs, const AssemblerOptions *options);
+
+#endif /* WORKER_POOL_H */